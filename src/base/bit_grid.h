@@ -0,0 +1,106 @@
+// BitGrid is a 2D array of bits. Each row (a fixed y) is packed into whole
+// 64-bit words, so rows start on word boundaries and two grids can be merged
+// a word at a time, even when one is offset from the other.
+//
+// Bits past the end of a row in its last word are padding and are always 0.
+
+#ifndef __BABEL_BASE_BIT_GRID_H__
+#define __BABEL_BASE_BIT_GRID_H__
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "base/debug.h"
+#include "base/point.h"
+
+namespace babel {
+
+class BitGrid {
+ public:
+  BitGrid(const Point& size=Point())
+      : size_(size), words_per_row_((size.x + 63)/64),
+        words_(words_per_row_*size.y, 0) {
+    ASSERT(size.x >= 0 && size.y >= 0);
+  }
+
+  const Point& GetSize() const { return size_; }
+
+  bool InBounds(const Point& square) const {
+    return (0 <= square.x && square.x < size_.x &&
+            0 <= square.y && square.y < size_.y);
+  }
+
+  // The square must be in bounds.
+  bool Get(const Point& square) const {
+    return (Word(square) >> (square.x & 63)) & 1;
+  }
+  void Set(const Point& square) {
+    Word(square) |= 1ULL << (square.x & 63);
+  }
+  void Reset(const Point& square) {
+    Word(square) &= ~(1ULL << (square.x & 63));
+  }
+
+  void Clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+  }
+
+  // Clears every bit that is not set in the other grid, which must be the
+  // same size as this one.
+  void And(const BitGrid& other) {
+    ASSERT(other.size_ == size_);
+    for (size_t i = 0; i < words_.size(); i++) {
+      words_[i] &= other.words_[i];
+    }
+  }
+
+  // Sets every bit that is set in the other grid, placing its (0, 0) at the
+  // given offset in this grid. Bits that land outside this grid are dropped.
+  void Or(const BitGrid& other, const Point& offset) {
+    const int min_y = std::max(0, -offset.y);
+    const int max_y = std::min(other.size_.y, size_.y - offset.y);
+    // Source bit 64*i in a row lands at bit 64*(i + word) + shift in the
+    // destination row, where word may be negative.
+    const int word = (offset.x >= 0 ? offset.x/64 : -((63 - offset.x)/64));
+    const int shift = offset.x - 64*word;
+    for (int y = min_y; y < max_y; y++) {
+      const uint64_t* source = other.Row(y);
+      uint64_t* target = Row(y + offset.y);
+      for (int i = 0; i < other.words_per_row_; i++) {
+        const int j = i + word;
+        if (0 <= j && j < words_per_row_) {
+          target[j] |= source[i] << shift;
+        }
+        if (shift != 0 && 0 <= j + 1 && j + 1 < words_per_row_) {
+          target[j + 1] |= source[i] >> (64 - shift);
+        }
+      }
+      if (words_per_row_ > 0 && (size_.x & 63) != 0) {
+        target[words_per_row_ - 1] &= (1ULL << (size_.x & 63)) - 1;
+      }
+    }
+  }
+
+  const uint64_t* Row(int y) const {
+    return words_.data() + y*words_per_row_;
+  }
+  uint64_t* Row(int y) { return words_.data() + y*words_per_row_; }
+  int GetWordsPerRow() const { return words_per_row_; }
+
+ private:
+  const uint64_t& Word(const Point& square) const {
+    return words_[square.y*words_per_row_ + (square.x >> 6)];
+  }
+  uint64_t& Word(const Point& square) {
+    return words_[square.y*words_per_row_ + (square.x >> 6)];
+  }
+
+  Point size_;
+  int words_per_row_;
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace babel
+
+#endif  // __BABEL_BASE_BIT_GRID_H__
@@ -0,0 +1,84 @@
+#include "base/histogram.h"
+
+#include <algorithm>
+
+#include "base/debug.h"
+
+namespace babel {
+
+namespace {
+
+// Values below 2^kExactBits have a bucket each. Each larger power of two is
+// split into 2^kSubBucketBits buckets.
+static const int kExactBits = 5;
+static const int kSubBucketBits = 4;
+static const int kNumExactBuckets = 1 << kExactBits;
+static const int kSubBuckets = 1 << kSubBucketBits;
+
+// Enough buckets for every non-negative long long.
+static const int kNumBuckets = kNumExactBuckets + (63 - kExactBits)*kSubBuckets;
+
+int GetHighestBit(long long value) {
+  int result = 0;
+  while (value >>= 1) {
+    result += 1;
+  }
+  return result;
+}
+
+int GetBucket(long long value) {
+  if (value < kNumExactBuckets) {
+    return value;
+  }
+  // The highest bit selects a power of two, and the kSubBucketBits bits
+  // below it select a bucket within it.
+  const int bit = GetHighestBit(value);
+  const int sub_bucket = (value >> (bit - kSubBucketBits)) & (kSubBuckets - 1);
+  return kNumExactBuckets + (bit - kExactBits)*kSubBuckets + sub_bucket;
+}
+
+long long GetBucketStart(int bucket) {
+  if (bucket < kNumExactBuckets) {
+    return bucket;
+  }
+  const int bit = kExactBits + (bucket - kNumExactBuckets)/kSubBuckets;
+  const long long sub_bucket = (bucket - kNumExactBuckets) % kSubBuckets;
+  return (kSubBuckets + sub_bucket) << (bit - kSubBucketBits);
+}
+
+}  // namespace
+
+Histogram::Histogram() : counts_(kNumBuckets, 0) {}
+
+void Histogram::Add(long long value) {
+  ASSERT(value >= 0);
+  counts_[GetBucket(value)] += 1;
+  count_ += 1;
+  sum_ += value;
+}
+
+void Histogram::Merge(const Histogram& other) {
+  for (int i = 0; i < kNumBuckets; i++) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
+
+long long Histogram::Percentile(double p) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  const long long rank = std::min(count_ - 1, (long long)(p*count_));
+  long long seen = 0;
+  for (int i = 0; i < kNumBuckets; i++) {
+    seen += counts_[i];
+    if (seen > rank) {
+      return GetBucketStart(i);
+    }
+  }
+  ASSERT(false);
+  return 0;
+}
+
+}  // namespace babel
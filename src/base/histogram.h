@@ -0,0 +1,36 @@
+// Histogram counts non-negative samples, such as latencies in microseconds,
+// in a fixed set of buckets, so its size does not grow with the number of
+// samples. Values below 32 have a bucket each. Larger values share 16 buckets
+// per power of two, so a percentile is reported as the low end of a bucket
+// that is at most 1/16 of its value wide.
+
+#ifndef __BABEL_BASE_HISTOGRAM_H__
+#define __BABEL_BASE_HISTOGRAM_H__
+
+#include <vector>
+
+namespace babel {
+
+class Histogram {
+ public:
+  Histogram();
+
+  void Add(long long value);
+  void Merge(const Histogram& other);
+
+  long long count() const { return count_; }
+  long long sum() const { return sum_; }
+
+  // Returns the sample at rank p*count (clamped to the last sample) in sorted
+  // order, rounded down to its bucket. Returns 0 if there are no samples.
+  long long Percentile(double p) const;
+
+ private:
+  std::vector<long long> counts_;
+  long long count_ = 0;
+  long long sum_ = 0;
+};
+
+}  // namespace babel
+
+#endif  // __BABEL_BASE_HISTOGRAM_H__
@@ -6,7 +6,7 @@
 #include "base/debug.h"
 
 namespace babel {
-namespace {
+namespace internal {
 
 template<typename T>
 struct CircularListNode {
@@ -17,7 +17,7 @@ struct CircularListNode {
   CircularListNode<T>* next;
 };
 
-}  // namespace
+}  // namespace internal
 
 template<typename K,typename V>
 class LRUCache {
@@ -39,24 +39,40 @@ class LRUCache {
     if (values_.find(key) == values_.end()) {
       return nullptr;
     }
-    CircularListNode<K>* node = priorities_.at(key);
+    internal::CircularListNode<K>* node = priorities_.at(key);
     Remove(node);
     Insert(node);
     return values_.at(key);
   }
 
+  // Removes the key from the cache without deleting its value, which the
+  // caller now owns. Returns nullptr if the key has been evicted.
+  V* Release(K key) {
+    if (values_.find(key) == values_.end()) {
+      return nullptr;
+    }
+    V* value = values_.at(key);
+    internal::CircularListNode<K>* node = priorities_.at(key);
+    values_.erase(key);
+    priorities_.erase(key);
+    Remove(node);
+    delete node;
+    return value;
+  }
+
   // This method will crash if the value is null or if the key is already
   // present in the crash. The cache takes ownership of the value pointer.
   void Set(K key, V* value) {
     ASSERT(values_.find(key) == values_.end());
     ASSERT(value != nullptr);
-    CircularListNode<K>* node = new CircularListNode<K>(key);
+    internal::CircularListNode<K>* node =
+        new internal::CircularListNode<K>(key);
     values_[key] = value;
     priorities_[key] = node;
     Insert(node);
 
-    if (values_.size() > capacity_) {
-      CircularListNode<K>* back = head_->prev;
+    if ((int)values_.size() > capacity_) {
+      internal::CircularListNode<K>* back = head_->prev;
       const K& evicted = back->key;
       delete values_.at(evicted);
       values_.erase(evicted);
@@ -68,7 +84,7 @@ class LRUCache {
 
  private:
   // All insertions happen at the head of the list.
-  void Insert(CircularListNode<K>* node) {
+  void Insert(internal::CircularListNode<K>* node) {
     if (head_ == nullptr) {
       node->prev = node;
       node->next = node;
@@ -82,7 +98,7 @@ class LRUCache {
   }
 
   // The caller owns the removed node. They may destruct it or re-insert it.
-  void Remove(CircularListNode<K>* node) {
+  void Remove(internal::CircularListNode<K>* node) {
     node->prev->next = node->next;
     node->next->prev = node->prev;
     if (node == head_) {
@@ -92,10 +108,10 @@ class LRUCache {
 
   const int capacity_;
   std::map<K,V*> values_;
-  std::map<K,CircularListNode<K>*> priorities_;
-  CircularListNode<K>* head_;
+  std::map<K,internal::CircularListNode<K>*> priorities_;
+  internal::CircularListNode<K>* head_;
 };
 
-}  // namespace std
+}  // namespace babel
 
 #endif  // __BABEL_BASE_LRU_CACHE_H__
@@ -0,0 +1,20 @@
+#include "base/rng.h"
+
+namespace babel {
+
+void RNG::Seed(uint32_t seed) {
+  // Expand the seed with splitmix64, as the xoshiro authors recommend, so that
+  // similar seeds produce unrelated states.
+  uint64_t x = seed;
+  for (int i = 0; i < 4; i += 2) {
+    x += 0x9e3779b97f4a7c15ULL;
+    uint64_t z = x;
+    z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+    state_[i] = static_cast<uint32_t>(z);
+    state_[i + 1] = static_cast<uint32_t>(z >> 32);
+  }
+}
+
+}  // namespace babel
@@ -0,0 +1,61 @@
+// A small, fast, seedable pseudo-random number generator (xoshiro128**).
+//
+// Unlike rand(), an RNG has no hidden global state and takes no locks, so each
+// game can own one: games can be simulated on different threads, and a game
+// is exactly reproducible from its seed on any platform.
+
+#ifndef __BABEL_BASE_RNG_H__
+#define __BABEL_BASE_RNG_H__
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "base/debug.h"
+
+namespace babel {
+
+class RNG {
+ public:
+  RNG(uint32_t seed = 0) { Seed(seed); }
+
+  void Seed(uint32_t seed);
+
+  uint32_t Next() {
+    const uint32_t result = Rotate(state_[1]*5, 7)*9;
+    const uint32_t shifted = state_[1] << 9;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= shifted;
+    state_[3] = Rotate(state_[3], 11);
+    return result;
+  }
+
+  // Returns a random integer in [0, n). n must be positive.
+  int Uniform(int n) {
+    ASSERT(n > 0);
+    return Next() % n;
+  }
+
+  // Shuffles the list in place. We don't use std::shuffle because its results
+  // depend on the standard library implementation.
+  template<typename T>
+  void Shuffle(std::vector<T>* list) {
+    for (int i = list->size() - 1; i > 0; i--) {
+      std::swap((*list)[i], (*list)[Uniform(i + 1)]);
+    }
+  }
+
+ private:
+  static uint32_t Rotate(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+  }
+
+  uint32_t state_[4];
+};
+
+}  // namespace babel
+
+#endif  // __BABEL_BASE_RNG_H__
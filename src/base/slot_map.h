@@ -0,0 +1,124 @@
+// SlotMap stores values densely in a vector and hands out generational handles
+// to them. Adding a value, removing a value, and looking up a handle are O(1).
+//
+// Removing a value moves the last value into its place, so iteration order is
+// not stable. Each time a slot is reused its generation is incremented, so a
+// stale handle to a removed value is detected instead of being dereferenced.
+// Other arrays can be kept parallel to the dense values by mirroring this move.
+//
+// Handles are 32 bits: the low kIndexBits bits are the slot index and the rest
+// are the slot's generation. Generations start at 1, so 0 is never a handle.
+// A slot whose generation reaches kMaxGeneration is retired when its value is
+// removed instead of wrapping around, so no handle is ever handed out twice.
+// Retiring costs one slot per kMaxGeneration removals from it.
+
+#ifndef __BABEL_BASE_SLOT_MAP_H__
+#define __BABEL_BASE_SLOT_MAP_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/debug.h"
+
+namespace babel {
+
+template<typename T>
+class SlotMap {
+ public:
+  typedef uint32_t Handle;
+  typedef typename std::vector<T>::iterator iterator;
+  typedef typename std::vector<T>::const_iterator const_iterator;
+
+  static const int kIndexBits = 20;
+  static const uint32_t kIndexMask = (1 << kIndexBits) - 1;
+  static const uint32_t kMaxGeneration = (1 << (32 - kIndexBits)) - 1;
+
+  Handle Add(const T& value) {
+    uint32_t index;
+    if (free_slots_.empty()) {
+      index = slots_.size();
+      ASSERT(index <= kIndexMask);
+      slots_.push_back(Slot{1, -1});
+    } else {
+      index = free_slots_.back();
+      free_slots_.pop_back();
+    }
+    Slot& slot = slots_[index];
+    slot.dense_index = values_.size();
+    const Handle handle = (slot.generation << kIndexBits) | index;
+    values_.push_back(value);
+    handles_.push_back(handle);
+    return handle;
+  }
+
+  // Crashes if the handle is stale.
+  void Remove(Handle handle) {
+    ASSERT(Contains(handle));
+    const uint32_t index = handle & kIndexMask;
+    Slot& slot = slots_[index];
+    // Move the last value into the removed value's place.
+    const int last = values_.size() - 1;
+    values_[slot.dense_index] = values_[last];
+    handles_[slot.dense_index] = handles_[last];
+    slots_[handles_[last] & kIndexMask].dense_index = slot.dense_index;
+    values_.pop_back();
+    handles_.pop_back();
+    slot.dense_index = -1;
+    if (slot.generation < kMaxGeneration) {
+      slot.generation += 1;
+      free_slots_.push_back(index);
+    }
+  }
+
+  bool Contains(Handle handle) const {
+    const uint32_t index = handle & kIndexMask;
+    return (index < slots_.size() && slots_[index].dense_index >= 0 &&
+            slots_[index].generation == handle >> kIndexBits);
+  }
+
+  // Returns nullptr if the handle is stale.
+  T* Get(Handle handle) {
+    return Contains(handle) ?
+        &values_[slots_[handle & kIndexMask].dense_index] : nullptr;
+  }
+
+  const T* Get(Handle handle) const {
+    return Contains(handle) ?
+        &values_[slots_[handle & kIndexMask].dense_index] : nullptr;
+  }
+
+  // Returns the dense index of the handle's value. Crashes if it is stale.
+  int Index(Handle handle) const {
+    ASSERT(Contains(handle));
+    return slots_[handle & kIndexMask].dense_index;
+  }
+
+  // Values may also be accessed by dense index, in [0, size()).
+  T& operator[](int index) { return values_[index]; }
+  const T& operator[](int index) const { return values_[index]; }
+
+  int size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+
+  iterator begin() { return values_.begin(); }
+  iterator end() { return values_.end(); }
+  const_iterator begin() const { return values_.begin(); }
+  const_iterator end() const { return values_.end(); }
+
+ private:
+  struct Slot {
+    uint32_t generation;
+    // The index of this slot's value in values_, or -1 if the slot is free.
+    int dense_index;
+  };
+
+  // values_ and handles_ are parallel, dense arrays.
+  std::vector<T> values_;
+  std::vector<Handle> handles_;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+};
+
+}  // namespace babel
+
+#endif  // __BABEL_BASE_SLOT_MAP_H__
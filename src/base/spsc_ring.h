@@ -0,0 +1,71 @@
+// SpscRing is a bounded, lock-free queue for exactly one producer thread and
+// one consumer thread. TryPush may only be called by the producer and TryPop
+// only by the consumer; neither ever blocks or allocates.
+//
+// The producer only writes tail_ and the consumer only writes head_, so each
+// index is published with a release store and read with an acquire load.
+
+#ifndef __BABEL_BASE_SPSC_RING_H__
+#define __BABEL_BASE_SPSC_RING_H__
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/debug.h"
+
+namespace babel {
+
+template<typename T>
+class SpscRing {
+ public:
+  // The ring holds up to capacity values. One extra slot is allocated to
+  // tell a full ring from an empty one.
+  SpscRing(int capacity) : slots_(capacity + 1) {
+    ASSERT(capacity > 0);
+  }
+
+  // Returns false, and drops the value, if the ring is full.
+  bool TryPush(const T& value) {
+    const int tail = tail_.load(std::memory_order_relaxed);
+    const int next = Next(tail);
+    if (next == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    slots_[tail] = value;
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Returns false, and leaves value untouched, if the ring is empty.
+  bool TryPop(T* value) {
+    const int head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = std::move(slots_[head]);
+    head_.store(Next(head), std::memory_order_release);
+    return true;
+  }
+
+  // May be called from either thread, but it is only a snapshot.
+  bool IsEmpty() const {
+    return (head_.load(std::memory_order_acquire) ==
+            tail_.load(std::memory_order_acquire));
+  }
+
+ private:
+  int Next(int index) const {
+    return index + 1 == (int)slots_.size() ? 0 : index + 1;
+  }
+
+  std::vector<T> slots_;
+  // The indices are kept on separate cache lines so that the producer and
+  // consumer do not contend for the same line.
+  alignas(64) std::atomic<int> head_{0};
+  alignas(64) std::atomic<int> tail_{0};
+};
+
+}  // namespace babel
+
+#endif  // __BABEL_BASE_SPSC_RING_H__
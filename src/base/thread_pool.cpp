@@ -0,0 +1,79 @@
+#include "base/thread_pool.h"
+
+#include <algorithm>
+
+#include "base/debug.h"
+
+namespace babel {
+
+ThreadPool::ThreadPool(int num_threads) {
+  ASSERT(num_threads > 0);
+#if !defined(EMSCRIPTEN) || defined(__EMSCRIPTEN_PTHREADS__)
+  for (int i = 1; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPool::Work, this);
+  }
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_ready_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Run(int num_tasks, const std::function<void(int)>& task) {
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_ = &task;
+  num_tasks_ = num_tasks;
+  next_task_ = 0;
+  pending_tasks_ = num_tasks;
+  work_ready_.notify_all();
+  RunTasks(&lock);
+  work_done_.wait(lock, [this]{ return pending_tasks_ == 0; });
+  task_ = nullptr;
+  num_tasks_ = 0;
+  next_task_ = 0;
+}
+
+void ThreadPool::Work() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_ready_.wait(lock, [this]{
+      return stopping_ || next_task_ < num_tasks_;
+    });
+    if (stopping_) {
+      return;
+    }
+    RunTasks(&lock);
+  }
+}
+
+void ThreadPool::RunTasks(std::unique_lock<std::mutex>* lock) {
+  while (next_task_ < num_tasks_) {
+    const int index = next_task_++;
+    const std::function<void(int)>& task = *task_;
+    lock->unlock();
+    task(index);
+    lock->lock();
+    pending_tasks_ -= 1;
+    if (pending_tasks_ == 0) {
+      work_done_.notify_all();
+    }
+  }
+}
+
+ThreadPool* GetSharedThreadPool() {
+  // hardware_concurrency may return 0 if it is unknown. The pool is leaked,
+  // so that it outlives any thread that still uses it at exit.
+  static ThreadPool* pool =
+      new ThreadPool(std::max((int)std::thread::hardware_concurrency(), 1));
+  return pool;
+}
+
+}  // namespace babel
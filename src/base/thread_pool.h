@@ -0,0 +1,57 @@
+// ThreadPool runs batches of small, independent tasks on a fixed set of
+// worker threads. The thread that calls Run works on the batch too, and Run
+// returns only once every task in the batch has returned, so tasks may
+// write to memory that the caller reads afterwards without further locking.
+//
+// Run may be called from any thread, but batches run one at a time. In
+// emscripten builds without pthreads, the pool has no workers and Run calls
+// every task on the calling thread.
+
+#ifndef __BABEL_BASE_THREAD_POOL_H__
+#define __BABEL_BASE_THREAD_POOL_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace babel {
+
+class ThreadPool {
+ public:
+  // Starts num_threads - 1 workers, since the caller of Run is the last.
+  ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  int GetNumThreads() const { return workers_.size() + 1; }
+
+  // Calls task(i) for each i in [0, num_tasks), in no particular order.
+  void Run(int num_tasks, const std::function<void(int)>& task);
+
+ private:
+  void Work();
+  // Runs tasks from the current batch until none are left to start. The
+  // lock must be held on entry, and is held on exit.
+  void RunTasks(std::unique_lock<std::mutex>* lock);
+
+  std::mutex run_mutex_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  const std::function<void(int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int pending_tasks_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+// Returns a pool with one thread per core that the whole process shares. It
+// is started on the first call and never destroyed. Since batches run one at
+// a time, callers that share it may wait for each other's batches.
+ThreadPool* GetSharedThreadPool();
+
+}  // namespace babel
+
+#endif  // __BABEL_BASE_THREAD_POOL_H__
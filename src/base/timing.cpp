@@ -1,8 +1,8 @@
 #include "base/timing.h"
 
+#include <chrono>
 #include <iostream>
 #include <string>
-#include <sys/time.h>
 #include <thread>
 #include <vector>
 
@@ -14,20 +14,20 @@ using std::vector;
 namespace babel {
 
 namespace {
-static const tick kTicksPerSecond = 1000000;
-bool gBackingOut = true;
-bool gVerbose = true;
-vector<tick> gTimers;
+// Timer state is per-thread, so that games running on different threads of
+// the same process do not interleave their timers.
+thread_local bool gBackingOut = true;
+thread_local bool gVerbose = true;
+thread_local vector<tick> gTimers;
 }  // namespace
 
 tick GetCurrentTick() {
-  // All times are stored ticks, which are in units of microseconds.
-  static long long min_time = 0;
-  static timeval time;
-  gettimeofday(&time, nullptr);
-  long long result = time.tv_sec*kTicksPerSecond+ time.tv_usec - min_time;
-  min_time = std::min(result, min_time);
-  return result;
+  // All times are stored ticks, which are in units of microseconds. They are
+  // read from a monotonic clock, so they never jump back if the wall clock is
+  // changed, but they are only meaningful relative to each other.
+  using namespace std::chrono;
+  const auto now = steady_clock::now().time_since_epoch();
+  return duration_cast<microseconds>(now).count();
 }
 
 void StartTimer(const std::string& name) {
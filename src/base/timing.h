@@ -7,9 +7,11 @@ namespace babel {
 
 typedef long long tick;
 
+// Returns the current time of a monotonic clock, in microseconds.
 tick GetCurrentTick();
 
-// All calls to StartTimer have to be followed by a call to EndTimer.
+// All calls to StartTimer have to be followed by a call to EndTimer on the
+// same thread. Timers and their verbosity are tracked separately per thread.
 void StartTimer(const std::string& name);
 void EndTimer();
 
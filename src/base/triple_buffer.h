@@ -0,0 +1,54 @@
+// TripleBuffer passes snapshots from one writer thread to one reader thread
+// without either of them ever blocking. The writer fills in the back buffer
+// and publishes it; the reader picks up the most recently published buffer.
+// Snapshots that are published before the reader picks them up are dropped,
+// and the reader never sees a buffer that the writer is still filling in.
+//
+// The three buffers rotate between the writer (back), the reader (front),
+// and a shared middle slot. Publishing and picking up are each a single
+// atomic exchange with the middle slot, which also carries a dirty bit.
+
+#ifndef __BABEL_BASE_TRIPLE_BUFFER_H__
+#define __BABEL_BASE_TRIPLE_BUFFER_H__
+
+#include <atomic>
+
+namespace babel {
+
+template<typename T>
+class TripleBuffer {
+ public:
+  // Writer methods. Back returns the buffer to fill in, which may hold an
+  // old snapshot. After Publish, Back returns a different buffer.
+  T& Back() { return buffers_[back_]; }
+
+  void Publish() {
+    back_ = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  // Reader methods. Update picks up the latest published snapshot and
+  // returns true if there was one that the reader has not seen yet.
+  bool Update() {
+    if ((middle_.load(std::memory_order_relaxed) & kDirty) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  const T& Front() const { return buffers_[front_]; }
+
+ private:
+  static const int kIndexMask = 3;
+  static const int kDirty = 4;
+
+  T buffers_[3];
+  int back_ = 0;
+  int front_ = 1;
+  std::atomic<int> middle_{2};
+};
+
+}  // namespace babel
+
+#endif  // __BABEL_BASE_TRIPLE_BUFFER_H__
@@ -32,7 +32,8 @@ EMSCRIPTEN_BINDINGS(value_types) {
 
   value_object<engine::TileView>("BabelTile")
     .field("graphic", &engine::TileView::graphic)
-    .field("visible", &engine::TileView::visible);
+    .field("visible", &engine::TileView::visible)
+    .field("light", &engine::TileView::light);
 
   value_object<engine::SpriteView>("BabelSprite")
     .field("id", &engine::SpriteView::id)
@@ -42,12 +43,16 @@ EMSCRIPTEN_BINDINGS(value_types) {
   value_object<engine::StatusView>("BabelStatus")
     .field("cur_health", &engine::StatusView::cur_health)
     .field("max_health", &engine::StatusView::max_health);
+
+  value_object<engine::UpdateResult>("BabelUpdateResult")
+    .field("changed", &engine::UpdateResult::changed)
+    .field("pending", &engine::UpdateResult::pending);
 };
 
 // Actions go here. We need a helper method to construct each one.
 
 inline engine::Action* MakeMoveAction(const Point point) {
-  return new engine::MoveAction(point);
+  return new engine::Action(engine::Action::Move(point));
 }
 
 EMSCRIPTEN_BINDINGS(action) {
@@ -58,11 +63,18 @@ EMSCRIPTEN_BINDINGS(action) {
 EMSCRIPTEN_BINDINGS(engine_view) {
   class_<engine::Engine>("BabelEngine")
     .constructor<>()
+    .constructor<uint32_t>()
     .function("AddEventHandler", &engine::Engine::AddEventHandler,
               allow_raw_pointers())
-    .function("AddInput", &engine::Engine::AddInput, allow_raw_pointers())
+    .function("AddInput",
+              select_overload<void(engine::Action*)>(&engine::Engine::AddInput),
+              allow_raw_pointers())
+    .function("GetSeed", &engine::Engine::GetSeed)
     .function("GetView", &engine::Engine::GetView, allow_raw_pointers())
-    .function("Update", &engine::Engine::Update);
+    .function("Update", select_overload<bool()>(&engine::Engine::Update))
+    .function("UpdateWithBudget",
+              select_overload<engine::UpdateResult(int, int)>(
+                  &engine::Engine::Update));
 
   class_<engine::View>("BabelView")
     .property("offset", &engine::View::offset)
@@ -80,8 +92,8 @@ void OnPageCompletion(engine::Engine* engine) {
     DEBUG("Failed to get dialog for OnPageCompletion handler.");
     return;
   }
-  engine::Action* action = dialog->OnPageCompletion();
-  if (action != nullptr) {
+  const engine::Action action = dialog->OnPageCompletion();
+  if (action.type != engine::ActionType::NONE) {
     engine->AddInput(action);
   }
 }
@@ -92,8 +104,8 @@ void OnTaskCompletion(engine::Engine* engine) {
     DEBUG("Failed to get dialog for OnTaskCompletion handler.");
     return;
   }
-  engine::Action* action = dialog->OnTaskCompletion();
-  if (action != nullptr) {
+  const engine::Action action = dialog->OnTaskCompletion();
+  if (action.type != engine::ActionType::NONE) {
     engine->AddInput(action);
   }
 }
@@ -104,8 +116,8 @@ void OnTaskError(engine::Engine* engine) {
     DEBUG("Failed to get dialog for OnTaskError handler.");
     return;
   }
-  engine::Action* action = dialog->OnTaskError();
-  if (action != nullptr) {
+  const engine::Action action = dialog->OnTaskError();
+  if (action.type != engine::ActionType::NONE) {
     engine->AddInput(action);
   }
 }
@@ -9,7 +9,10 @@
 #include "engine/GameState.h"
 #include "engine/Sprite.h"
 
+using babel::engine::Action;
 using babel::engine::ActionResult;
+using babel::engine::CombatLine;
+using babel::engine::EventHandler;
 using babel::engine::GameState;
 using babel::engine::Sprite;
 using std::max;
@@ -17,65 +20,90 @@ using std::string;
 
 namespace babel {
 namespace dialog {
+namespace {
+
+// The enemy is whichever of the two sprites is not the player.
+string GetCombatLine(CombatLine line, const Sprite& source,
+                     const Sprite& target) {
+  const Sprite& sprite = (source.IsPlayer() ? target : source);
+  const string& enemy = sprite.creature()->appearance.name;
+  switch (line) {
+    case CombatLine::KILL_ENEMY:
+      return "You kill the " + enemy + ".";
+    case CombatLine::HIT_ENEMY:
+      return "You hit the " + enemy + ".";
+    case CombatLine::ENEMY_HITS:
+      return "The " + enemy + " hits!";
+  }
+  ASSERT(false);
+  return "";
+}
+
+}  // namespace
 
 bool DefendsWithDialog(const GameState& game_state,
                        const Sprite& sprite, int damage) {
   if (game_state.dialog != nullptr) {
     return game_state.dialog->IsInvolved(sprite);
   }
-  return sprite.type == mGecko;
+  return sprite.type() == mGecko;
 }
 
-LaunchDialogAction::LaunchDialogAction(Sprite* target) : target_(target) {}
-
-ActionResult LaunchDialogAction::Execute() {
-  ASSERT(sprite_->IsPlayer());
+ActionResult ExecuteLaunchDialog(const Action& action, Sprite* sprite,
+                                 GameState* game_state,
+                                 EventHandler* handler) {
+  ASSERT(sprite->IsPlayer());
   ActionResult result;
+  Sprite* target = game_state->GetSprite(action.target);
+  if (target == nullptr) {
+    return result;
+  }
 
-  if (game_state_->dialog != nullptr) {
-    ASSERT(game_state_->dialog->IsInvolved(*target_));
-    if (game_state_->dialog->OnAttack(
-            game_state_, handler_, sprite_, target_)) {
-      game_state_->dialog.reset(nullptr);
+  if (game_state->dialog != nullptr) {
+    ASSERT(game_state->dialog->IsInvolved(*target));
+    if (game_state->dialog->OnAttack(game_state, handler, sprite, target)) {
+      game_state->dialog.reset(nullptr);
     }
     result.success = true;
     return result;
   }
 
-  ASSERT(target_->type == mGecko);
-  game_state_->dialog.reset(
-      new TransliterationCombatDialog(sprite_, target_));
+  ASSERT(target->type() == mGecko);
+  game_state->dialog.reset(new TransliterationCombatDialog(sprite, target));
   result.stalled = true;
   return result;
 }
 
-ExecuteCombatAction::ExecuteCombatAction(
-    bool complete, int damage, const string& line,
-    Sprite* source, Sprite* target)
-    : complete_(complete), damage_(damage), line_(line),
-      source_(source), target_(target) {}
-
-ActionResult ExecuteCombatAction::Execute() {
+ActionResult ExecuteCombat(const Action& action, Sprite* sprite,
+                           GameState* game_state, EventHandler* handler) {
   ActionResult result;
-  const bool killed = damage_ >= target_->cur_health;
+  const Action::CombatArgs& args = action.combat;
+  Sprite* source = game_state->GetSprite(args.source);
+  Sprite* target = game_state->GetSprite(args.target);
+  if (source == nullptr || target == nullptr) {
+    return result;
+  }
+  bool complete = args.complete;
+  string line = GetCombatLine(args.line, *source, *target);
+  const bool killed = args.damage >= target->cur_health();
 
-  if (killed && target_->IsPlayer()) {
-    line_ += " You die...";
-    complete_ = true;
+  if (killed && target->IsPlayer()) {
+    line += " You die...";
+    complete = true;
   }
-  game_state_->log.AddLine(line_);
-  handler_->OnAttack(source_->Id(), target_->Id());
+  game_state->log.AddLine(line);
+  handler->OnAttack(source->Id(), target->Id());
 
-  target_->cur_health = max(target_->cur_health - damage_, 0);
-  if (killed && !target_->IsPlayer()) {
-    game_state_->RemoveNPC(target_);
+  target->set_cur_health(max(target->cur_health() - args.damage, 0));
+  if (killed && !target->IsPlayer()) {
+    game_state->RemoveNPC(target);
   }
 
-  if (complete_) {
-    game_state_->dialog.reset(nullptr);
+  if (complete) {
+    game_state->dialog.reset(nullptr);
   }
-  result.success = complete_;
-  result.stalled = !complete_;
+  result.success = complete;
+  result.stalled = !complete;
   return result;
 }
 
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "engine/Action.h"
+#include "engine/EventHandler.h"
 #include "engine/GameState.h"
 #include "engine/Sprite.h"
 
@@ -14,34 +15,15 @@ namespace dialog {
 bool DefendsWithDialog(const engine::GameState& game_state,
                        const engine::Sprite& target, int damage);
 
-class DialogAction : public engine::Action {
- public:
-  // DialogActions are queueable so that signals from the UI are never dropped.
-  bool Queueable() override { return true; }
-};
-
-class LaunchDialogAction : public DialogAction {
- public:
-  LaunchDialogAction(engine::Sprite* target);
-  engine::ActionResult Execute() override;
-
- private:
-  engine::Sprite* target_;
-};
-
-class ExecuteCombatAction : public DialogAction {
- public:
-  ExecuteCombatAction(bool complete, int damage, const std::string& line,
-                      engine::Sprite* source, engine::Sprite* target);
-  engine::ActionResult Execute() override;
-
- private:
-  bool complete_;
-  int damage_;
-  std::string line_;
-  engine::Sprite* source_;
-  engine::Sprite* target_;
-};
+// Implementations of the dialog action types. These are called by
+// engine::Action::Execute and have the same contract.
+engine::ActionResult ExecuteLaunchDialog(
+    const engine::Action& action, engine::Sprite* sprite,
+    engine::GameState* game_state, engine::EventHandler* handler);
+
+engine::ActionResult ExecuteCombat(
+    const engine::Action& action, engine::Sprite* sprite,
+    engine::GameState* game_state, engine::EventHandler* handler);
 
 }  // namespace dialog
 }  // namespace babel
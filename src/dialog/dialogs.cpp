@@ -10,6 +10,7 @@
 #include "dialog/actions.h"
 
 using babel::engine::Action;
+using babel::engine::CombatLine;
 using babel::engine::EventHandler;
 using babel::engine::GameState;
 using babel::engine::Sprite;
@@ -36,8 +37,9 @@ Dialog::~Dialog() {
 
 TransliterationCombatDialog::TransliterationCombatDialog(
     Sprite* source, Sprite* target)
-    : source_(source), target_(target),
-      enemy_(target->creature->appearance.name) {
+    : source_(source->Id()), target_(target->Id()),
+      enemy_(target->creature()->appearance.name),
+      enemy_max_health_(target->max_health()) {
   EM_ASM_INT({
     DialogManager.set_text('The ' + Module.Pointer_stringify($0) +
                            ' is vulnerable to transliteration:');
@@ -45,22 +47,22 @@ TransliterationCombatDialog::TransliterationCombatDialog(
   }, enemy_.c_str());
 }
 
-Action* TransliterationCombatDialog::OnPageCompletion() {
-  return new ExecuteCombatAction(
-      true /* complete */, target_->max_health /* damage */,
-      "You kill the " + enemy_ + ".", source_, target_);
+Action TransliterationCombatDialog::OnPageCompletion() {
+  return Action::ExecuteCombat(
+      true /* complete */, enemy_max_health_ /* damage */,
+      CombatLine::KILL_ENEMY, source_, target_);
 }
 
-Action* TransliterationCombatDialog::OnTaskCompletion() {
-  return new ExecuteCombatAction(
+Action TransliterationCombatDialog::OnTaskCompletion() {
+  return Action::ExecuteCombat(
       false /* complete */, 0 /* damage */,
-      "You hit the " + enemy_ + ".", source_, target_);
+      CombatLine::HIT_ENEMY, source_, target_);
 }
 
-Action* TransliterationCombatDialog::OnTaskError() {
-  return new ExecuteCombatAction(
+Action TransliterationCombatDialog::OnTaskError() {
+  return Action::ExecuteCombat(
       false /* complete */, 1 /* damage */,
-      "The " + enemy_ + " hits!", target_, source_);
+      CombatLine::ENEMY_HITS, target_, source_);
 }
 
 ReverseTransliterationDialog::ReverseTransliterationDialog(
@@ -78,7 +80,7 @@ ReverseTransliterationDialog::ReverseTransliterationDialog(
 
 void ReverseTransliterationDialog::AddEnemy(engine::Sprite* sprite) {
   EM_ASM_INT({ DialogManager._current.add_enemy($0); }, sprite->Id());
-  sprites_.insert(sprite);
+  sprites_.insert(sprite->Id());
 }
 
 int ReverseTransliterationDialog::GetNumEnemies() const {
@@ -86,13 +88,13 @@ int ReverseTransliterationDialog::GetNumEnemies() const {
 }
 
 bool ReverseTransliterationDialog::IsInvolved(const Sprite& sprite) const {
-  return sprites_.find(const_cast<engine::Sprite*>(&sprite)) != sprites_.end();
+  return sprites_.find(sprite.Id()) != sprites_.end();
 }
 
 bool ReverseTransliterationDialog::OnAttack(
     GameState* game_state, EventHandler* handler,
     Sprite* sprite, Sprite* target) {
-  const string& enemy = target->creature->appearance.name;
+  const string& enemy = target->creature()->appearance.name;
   const int result = EM_ASM_INT(
       { return DialogManager._current.on_attack($0); }, target->Id());
 
@@ -102,14 +104,17 @@ bool ReverseTransliterationDialog::OnAttack(
   }
   game_state->log.AddLine("You destroy the " + enemy + ".");
   handler->OnAttack(sprite->Id(), target->Id());
+  sprites_.erase(target->Id());
   game_state->RemoveNPC(target);
-  sprites_.erase(target);
   if (result == AttackResult::RIGHT_ENEMY) {
     return false;
   }
   if (sprites_.size() > 0) {
-    for (engine::Sprite* left : sprites_) {
-      game_state->RemoveNPC(left);
+    for (engine::sid left : sprites_) {
+      Sprite* other = game_state->GetSprite(left);
+      if (other != nullptr) {
+        game_state->RemoveNPC(other);
+      }
     }
     game_state->log.AddLine("The remainder of the host flees!");
   }
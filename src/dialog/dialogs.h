@@ -34,24 +34,25 @@ class Dialog {
       engine::Sprite* sprite, engine::Sprite* target) { return false; }
 
   // Handlers for dialog events that update state and that may return an action
-  // to pass to the game engine.
-  virtual engine::Action* OnPageCompletion() { return nullptr; }
-  virtual engine::Action* OnTaskCompletion() { return nullptr; }
-  virtual engine::Action* OnTaskError() { return nullptr; }
+  // to pass to the game engine. They return a NONE action if there is none.
+  virtual engine::Action OnPageCompletion() { return engine::Action(); }
+  virtual engine::Action OnTaskCompletion() { return engine::Action(); }
+  virtual engine::Action OnTaskError() { return engine::Action(); }
 };
 
 class TransliterationCombatDialog : public Dialog {
  public:
   TransliterationCombatDialog(engine::Sprite* source, engine::Sprite* target);
 
-  engine::Action* OnPageCompletion() override;
-  engine::Action* OnTaskCompletion() override;
-  engine::Action* OnTaskError() override;
+  engine::Action OnPageCompletion() override;
+  engine::Action OnTaskCompletion() override;
+  engine::Action OnTaskError() override;
 
  private:
-  engine::Sprite* source_;
-  engine::Sprite* target_;
+  const engine::sid source_;
+  const engine::sid target_;
   const std::string enemy_;
+  const int enemy_max_health_;
 };
 
 class ReverseTransliterationDialog : public Dialog {
@@ -67,7 +68,7 @@ class ReverseTransliterationDialog : public Dialog {
       engine::Sprite* sprite, engine::Sprite* target) override;
 
  private:
-  std::set<engine::Sprite*> sprites_;
+  std::set<engine::sid> sprites_;
   int num_enemies_ = 0;
 };
 
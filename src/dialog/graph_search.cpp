@@ -62,8 +62,7 @@ vector<Point> GetReachableSquares(
         const Point neighbor = square + move;
         if (visited.find(neighbor) == visited.end()) {
           visited.insert(neighbor);
-          if (!game_state.map->IsSquareBlocked(neighbor) &&
-              !game_state.IsSquareOccupied(neighbor)) {
+          if (!game_state.IsSquareBlockedOrOccupied(neighbor)) {
             result.push_back(neighbor);
             next->push_back(neighbor);
           }
@@ -33,8 +33,7 @@ void DialogGroupTrap::Trigger(GameState* game_state, EventHandler* handler) {
   // launch a dialog with that many enemies.
   vector<Point> free_squares;
   for (const Point& square : squares_) {
-    if (!game_state->map->IsSquareBlocked(square) &&
-        !game_state->IsSquareOccupied(square)) {
+    if (!game_state->IsSquareBlockedOrOccupied(square)) {
       free_squares.push_back(square);
     }
   }
@@ -49,17 +48,17 @@ void DialogGroupTrap::Trigger(GameState* game_state, EventHandler* handler) {
   // Block off the player within the trapped area.
   vector<Point> blocking_squares = GetBlockingSquares(*game_state, squares_);
   for (const Point& square : blocking_squares) {
-    game_state->map->SetTile(square, Tile::FENCE);
+    game_state->SetTile(square, Tile::FENCE);
   }
   game_state->RecomputePlayerVision();
   handler->OnSnapshot();
 
   // Spawn the new enemies and set the game's dialog to the new state.
-  std::random_shuffle(free_squares.begin(), free_squares.end());
+  game_state->rng.Shuffle(&free_squares);
   for (int i = 0; i < num_enemies; i++) {
-    Sprite* sprite = new Sprite(free_squares[i], mDrone);
-    game_state->AddNPC(sprite);
-    sprite->ConsumeEnergy();
+    // The drones lose a turn.
+    Sprite* sprite = game_state->AddNPC(
+        free_squares[i], mDrone, true /* exhausted */);
     dialog->AddEnemy(sprite);
   }
   game_state->log.AddLine("You are ambushed by a group of " +
@@ -1,6 +1,7 @@
 #include "engine/Action.h"
 
 #include <algorithm>
+#include <string>
 
 #include "dialog/actions.h"
 #include "engine/EventHandler.h"
@@ -16,127 +17,181 @@ namespace {
 
 void SetSquareAndLog(const Point& square, Tile tile, const string& text,
                      GameState* game_state, EventHandler* handler) {
-  game_state->map->SetTile(square, tile);
+  game_state->SetTile(square, tile);
   game_state->RecomputePlayerVision();
   // Check if we should log and animate the event.
-  const int radius = game_state->player->creature->stats.vision_radius;
-  if (game_state->player_vision->IsSquareVisible(square, radius)) {
+  if (game_state->CanPlayerSee(square)) {
     game_state->log.AddLine(text);
     handler->OnSnapshot();
   }
 }
 
-}  // namespace
-
-void Action::Bind(Sprite* sprite, GameState* game_state,
-                  EventHandler* handler) {
-  ASSERT(sprite != nullptr);
-  ASSERT(game_state != nullptr);
-  ASSERT(handler != nullptr);
-  // Check that Bind was not called twice for the same Action.
-  ASSERT(sprite_ == nullptr);
-  sprite_ = sprite;
-  game_state_ = game_state;
-  handler_ = handler;
-}
-
-AttackAction::AttackAction(Sprite* target) : target_(target) {}
-
-ActionResult AttackAction::Execute() {
+ActionResult ExecuteAttack(const Action& action, Sprite* sprite,
+                           GameState* game_state, EventHandler* handler) {
   ActionResult result;
+  Sprite* target = game_state->GetSprite(action.target);
+  if (target == nullptr) {
+    return result;
+  }
 
   // Compute the attack base damage.
   int damage = 0;
-  for (int i = 0; i < sprite_->creature->attack.dice; i++) {
-    damage += (rand() % sprite_->creature->attack.sides) + 1;
+  for (int i = 0; i < sprite->creature()->attack.dice; i++) {
+    damage += game_state->rng.Uniform(sprite->creature()->attack.sides) + 1;
   }
 
   // Exit early if the player is attacking an enemy with a combat dialog.
-  if (sprite_->IsPlayer() &&
-      dialog::DefendsWithDialog(*game_state_, *target_, damage)) {
-    result.alternate = new dialog::LaunchDialogAction(target_);
+  if (sprite->IsPlayer() &&
+      dialog::DefendsWithDialog(*game_state, *target, damage)) {
+    result.alternate = Action::LaunchDialog(target->Id());
     return result;
   }
 
   // Log and animate the attack.
-  const bool killed = damage >= target_->cur_health;
-  if (sprite_->IsPlayer()) {
+  const bool killed = damage >= target->cur_health();
+  if (sprite->IsPlayer()) {
     const string verb = (killed ? "kill" : "hit");
-    game_state_->log.AddLine("You " + verb + " the " +
-                             target_->creature->appearance.name + ".");
+    game_state->log.AddLine("You " + verb + " the " +
+                            target->creature()->appearance.name + ".");
   } else {
     const string followup = (killed ? " You die..." : "");
-    game_state_->log.AddLine(
-        "The " + sprite_->creature->appearance.name + " hits!" + followup);
+    game_state->log.AddLine(
+        "The " + sprite->creature()->appearance.name + " hits!" + followup);
   }
-  handler_->OnAttack(sprite_->Id(), target_->Id());
+  handler->OnAttack(sprite->Id(), target->Id());
 
   // Execute the attack and maybe kill the sprite.
-  target_->cur_health = max(target_->cur_health - damage, 0);
-  if (!target_->IsPlayer() && killed) {
-    game_state_->RemoveNPC(target_);
+  target->set_cur_health(max(target->cur_health() - damage, 0));
+  if (!target->IsPlayer() && killed) {
+    game_state->RemoveNPC(target);
   }
   result.success = true;
   return result;
 }
 
-MoveAction::MoveAction(const Point& move) : move_(move) {}
-
-ActionResult MoveAction::Execute() {
+ActionResult ExecuteMove(const Action& action, Sprite* sprite,
+                         GameState* game_state, EventHandler* handler) {
   ActionResult result;
-  Point square = sprite_->square + move_;
+  const Point move = action.GetSquare();
+  Point square = sprite->square() + move;
 
-  if (game_state_->map->IsSquareBlocked(square)) {
-    if (sprite_->IsPlayer()) {
-      result.alternate = new OpenDoorAction(square);
+  if (game_state->map->IsSquareBlocked(square)) {
+    if (sprite->IsPlayer()) {
+      result.alternate = Action::OpenDoor(square);
     }
     return result;
   }
 
-  if (square == sprite_->square) {
+  if (square == sprite->square()) {
     result.success = true;
-  } else if (game_state_->IsSquareOccupied(square)) {
-    result.alternate = new AttackAction(game_state_->SpriteAt(square));
+  } else if (game_state->IsSquareOccupied(square)) {
+    result.alternate = Action::Attack(game_state->SpriteAt(square)->Id());
   } else {
-    game_state_->MoveSprite(move_, sprite_);
-    if (sprite_->IsPlayer()) {
-      game_state_->MaybeTriggerTrap(square, handler_);
+    game_state->MoveSprite(move, sprite);
+    if (sprite->IsPlayer()) {
+      game_state->MaybeTriggerTrap(square, handler);
     }
     result.success = true;
   }
   return result;
 }
 
-OpenDoorAction::OpenDoorAction(const Point& square) : square_(square) {}
-
-ActionResult OpenDoorAction::Execute() {
+ActionResult ExecuteOpenDoor(const Action& action, Sprite* sprite,
+                             GameState* game_state, EventHandler* handler) {
   ActionResult result;
-  const Tile tile = game_state_->map->GetTile(square_);
+  const Point square = action.GetSquare();
+  const Tile tile = game_state->map->GetTile(square);
 
   if (!(tile == Tile::DOOR || tile == Tile::FENCE)) {
     return result;
   }
-  const string tense = (sprite_->IsPlayer() ? "" : "s");
+  const string tense = (sprite->IsPlayer() ? "" : "s");
   const string verb_phrase =
       (tile == Tile::DOOR ? "open" + tense + " the door" :
        "force" + tense + " open the fence");
 
-  if (game_state_->dialog != nullptr) {
-    if (sprite_->IsPlayer()) {
-      game_state_->log.AddLine("You're engaged in combat! "
-                               "You don't have time to " + verb_phrase + "!");
+  if (game_state->dialog != nullptr) {
+    if (sprite->IsPlayer()) {
+      game_state->log.AddLine("You're engaged in combat! "
+                              "You don't have time to " + verb_phrase + "!");
     }
     result.success = true;
     return result;
   }
 
-  const string noun = (sprite_->IsPlayer() ? "You" :
-                       "The " + sprite_->creature->appearance.name);
-  SetSquareAndLog(square_, Tile::FREE, noun + " " + verb_phrase + ".",
-                  game_state_, handler_);
+  const string noun = (sprite->IsPlayer() ? "You" :
+                       "The " + sprite->creature()->appearance.name);
+  SetSquareAndLog(square, Tile::FREE, noun + " " + verb_phrase + ".",
+                  game_state, handler);
   result.success = true;
   return result;
 }
 
+}  // namespace
+
+Action Action::Attack(sid target) {
+  Action action;
+  action.type = ActionType::ATTACK;
+  action.target = target;
+  return action;
+}
+
+Action Action::Move(const Point& move) {
+  Action action;
+  action.type = ActionType::MOVE;
+  action.square = SquareArgs{move.x, move.y};
+  return action;
+}
+
+Action Action::OpenDoor(const Point& square) {
+  Action action;
+  action.type = ActionType::OPEN_DOOR;
+  action.square = SquareArgs{square.x, square.y};
+  return action;
+}
+
+Action Action::LaunchDialog(sid target) {
+  Action action;
+  action.type = ActionType::LAUNCH_DIALOG;
+  action.target = target;
+  return action;
+}
+
+Action Action::ExecuteCombat(bool complete, int damage, CombatLine line,
+                             sid source, sid target) {
+  Action action;
+  action.type = ActionType::EXECUTE_COMBAT;
+  action.combat = CombatArgs{source, target, damage, line, complete};
+  return action;
+}
+
+ActionResult Action::Execute(Sprite* sprite, GameState* game_state,
+                             EventHandler* handler) const {
+  ASSERT(sprite != nullptr);
+  ASSERT(game_state != nullptr);
+  ASSERT(handler != nullptr);
+  switch (type) {
+    case ActionType::ATTACK:
+      return ExecuteAttack(*this, sprite, game_state, handler);
+    case ActionType::MOVE:
+      return ExecuteMove(*this, sprite, game_state, handler);
+    case ActionType::OPEN_DOOR:
+      return ExecuteOpenDoor(*this, sprite, game_state, handler);
+    case ActionType::LAUNCH_DIALOG:
+      return dialog::ExecuteLaunchDialog(*this, sprite, game_state, handler);
+    case ActionType::EXECUTE_COMBAT:
+      return dialog::ExecuteCombat(*this, sprite, game_state, handler);
+    case ActionType::NONE:
+      break;
+  }
+  ASSERT(false);
+  return ActionResult();
+}
+
+bool Action::Queueable() const {
+  return type == ActionType::LAUNCH_DIALOG ||
+         type == ActionType::EXECUTE_COMBAT;
+}
+
 }  // namespace engine
 }  // namespace babel
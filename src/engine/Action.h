@@ -1,68 +1,94 @@
 #ifndef __BABEL_ENGINE_ACTION_H__
 #define __BABEL_ENGINE_ACTION_H__
 
-#include <string>
-
 #include "base/point.h"
+#include "engine/Sprite.h"
 
 namespace babel {
 
 namespace engine {
 
-class Action;
+struct ActionResult;
 class EventHandler;
 class GameState;
-class Sprite;
 
-struct ActionResult {
-  bool success = false;
-  bool stalled = false;
-  Action* alternate = nullptr;
+// The closed set of action types. Dialog actions are implemented in the
+// dialog module, but they are dispatched here like any other action.
+enum ActionType {
+  NONE = 0,
+  ATTACK = 1,
+  MOVE = 2,
+  OPEN_DOOR = 3,
+  LAUNCH_DIALOG = 4,
+  EXECUTE_COMBAT = 5
 };
 
-class Action {
- public:
-  virtual ~Action() {};
-
-  // None of the input arguments may be null.
-  void Bind(Sprite* sprite, GameState* game_state, EventHandler* handler);
-  virtual ActionResult Execute() = 0;
-
-  // If this method returns true, then this action will be added to an input
-  // queue if the user enters it but the engine already has input.
-  virtual bool Queueable() { return false; }
-
- protected:
-  Sprite* sprite_ = nullptr;
-  GameState* game_state_ = nullptr;
-  EventHandler* handler_ = nullptr;
+// The line that an EXECUTE_COMBAT action logs. The line's text is filled in
+// with the enemy's name when the action executes, so actions never own text.
+enum CombatLine {
+  KILL_ENEMY = 0,
+  HIT_ENEMY = 1,
+  ENEMY_HITS = 2
 };
 
-class AttackAction : public Action {
+// Actions are small values - a type and that type's arguments - that are
+// dispatched with a switch on the type. The arguments are a union of one
+// payload per type, so actions are trivially copyable, and creating and
+// executing one never allocates. A default-constructed action has type NONE.
+class Action {
  public:
-  AttackAction(Sprite* target);
-  ActionResult Execute() override;
+  static Action Attack(sid target);
+  static Action Move(const Point& move);
+  static Action OpenDoor(const Point& square);
+  static Action LaunchDialog(sid target);
+  static Action ExecuteCombat(bool complete, int damage, CombatLine line,
+                              sid source, sid target);
 
- private:
-  Sprite* target_;
-};
+  Action() : type(ActionType::NONE), combat() {}
 
-class MoveAction : public Action {
- public:
-  MoveAction(const Point& move);
-  ActionResult Execute() override;
+  // None of the input arguments may be null. Must not be called on NONE.
+  // Actions refer to other sprites by id, and an action whose sprites have
+  // since been removed from the game fails without doing anything.
+  ActionResult Execute(Sprite* sprite, GameState* game_state,
+                       EventHandler* handler) const;
 
- private:
-  Point move_;
+  // If this method returns true, then this action will be added to an input
+  // queue if the user enters it but the engine already has input. Dialog
+  // actions are queueable so that signals from the UI are never dropped.
+  bool Queueable() const;
+
+  // Returns the square of a MOVE (an offset) or OPEN_DOOR (a position).
+  Point GetSquare() const { return Point(square.x, square.y); }
+
+  struct SquareArgs {
+    int x;
+    int y;
+  };
+  struct CombatArgs {
+    sid source;
+    sid target;
+    int damage;
+    CombatLine line;
+    bool complete;
+  };
+
+  ActionType type;
+
+  // The arguments. Only the member for the type is set: square for MOVE and
+  // OPEN_DOOR, target for ATTACK and LAUNCH_DIALOG, and combat for
+  // EXECUTE_COMBAT.
+  union {
+    SquareArgs square;
+    sid target;
+    CombatArgs combat;
+  };
 };
 
-class OpenDoorAction : public Action {
- public:
-  OpenDoorAction(const Point& square);
-  ActionResult Execute() override;
-
- private:
-  Point square_;
+struct ActionResult {
+  bool success = false;
+  bool stalled = false;
+  // Has type NONE if there is no alternate action.
+  Action alternate;
 };
 
 }  // namespace engine
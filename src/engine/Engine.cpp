@@ -1,9 +1,12 @@
 #include "engine/Engine.h"
 
 #include <algorithm>
+#include <ctime>
 #include <memory>
+#include <utility>
 
 #include "base/debug.h"
+#include "base/timing.h"
 #include "engine/Action.h"
 #include "engine/FieldOfVision.h"
 #include "engine/Sprite.h"
@@ -15,16 +18,47 @@ using std::unique_ptr;
 namespace babel {
 namespace engine {
 
-Engine::Engine() : game_state_("world.dat") {
+Engine::Engine() : Engine(time(nullptr)) {}
+
+Engine::Engine(uint32_t seed)
+    : seed_(seed), game_state_("world.dat", seed) {
   game_state_.log.AddLine(
       "Welcome to Babel! You are a neutral male human neophyte.");
   game_state_.log.Flush(true);
 }
 
-Engine::~Engine() {
-  for (auto* input : inputs_) {
-    delete input;
+Engine* Engine::Replay(const Journal& journal) {
+  unique_ptr<Engine> engine(new Engine(journal.GetSeed()));
+  engine->StartJournal();
+
+  // Each input is given to the engine when the previous update has stopped
+  // for player input, which is the turn at which the input was consumed.
+  size_t offset = journal.GetStartOffset();
+  long long turn;
+  Action input;
+  while (journal.Read(&offset, &turn, &input)) {
+    if (turn != engine->turn_) {
+      DEBUG("Replay diverged at turn " << engine->turn_ << ".");
+      return nullptr;
+    }
+    engine->inputs_.push_back(std::move(input));
+    engine->Update();
   }
+  if (offset != journal.GetBytes().size()) {
+    DEBUG("Journal is corrupt at byte " << offset << ".");
+    return nullptr;
+  }
+  if (engine->journal_->GetBytes() != journal.GetBytes()) {
+    DEBUG("Replay diverged at turn " << engine->turn_ << ".");
+    return nullptr;
+  }
+  return engine.release();
+}
+
+void Engine::StartJournal() {
+  ASSERT(journal_ == nullptr);
+  ASSERT(turn_ == 0 && !updating_);
+  journal_.reset(new Journal(seed_));
 }
 
 void Engine::AddEventHandler(EventHandler* handler) {
@@ -32,18 +66,35 @@ void Engine::AddEventHandler(EventHandler* handler) {
   handler_.handlers_.push_back(handler);
 }
 
+void Engine::AddInput(const Action& input) {
+  ASSERT(input.type != ActionType::NONE);
+  std::deque<Action>& inputs = (updating_ ? pending_inputs_ : inputs_);
+  if (inputs.empty() || input.Queueable()) {
+    inputs.push_back(input);
+  }
+}
+
 void Engine::AddInput(Action* input) {
   ASSERT(input != nullptr);
-  if (inputs_.empty() || input->Queueable()) {
-    inputs_.push_back(input);
-  }
+  unique_ptr<Action> owned(input);
+  AddInput(*owned);
 }
 
 bool Engine::Update() {
-  bool changed = false;
-  unique_ptr<Action> action;
+  return Update(0, 0).changed;
+}
 
-  game_state_.log.Open();
+UpdateResult Engine::Update(int budget_us, int max_steps) {
+  UpdateResult update;
+  Action action;
+
+  if (!updating_) {
+    game_state_.log.Open();
+    updating_ = true;
+    changed_ = false;
+  }
+  const tick start = (budget_us > 0 ? GetCurrentTick() : 0);
+  int steps = 0;
 
   while (true) {
     if (!game_state_.player->IsAlive()) {
@@ -52,54 +103,70 @@ bool Engine::Update() {
     // Find the next sprite with enough energy to move.
     Sprite* sprite = game_state_.GetCurrentSprite();
     ASSERT(sprite != nullptr);
-    if (!sprite->HasEnergyNeededToMove() && !sprite->GainEnergy()) {
-      game_state_.AdvanceSprite();
-      continue;
+    ASSERT(sprite->HasEnergyNeededToMove());
+    if (sprite->IsPlayer() && inputs_.size() == 0) {
+      break;
+    }
+    // Stop between turns if we are out of budget. Nothing is consumed until
+    // the turn starts, so the next update can pick up with this sprite.
+    if ((max_steps > 0 && steps >= max_steps) ||
+        (budget_us > 0 && GetCurrentTick() - start >= budget_us)) {
+      update.pending = true;
+      break;
     }
+    steps += 1;
     // Retrieve that sprite's next action, pulling from the input actions for
     // the player or getting an AI action for an NPC.
     if (sprite->IsPlayer()) {
-      if (inputs_.size() == 0) {
-        break;
-      }
-      action.reset(inputs_.back());
+      action = std::move(inputs_.back());
       inputs_.pop_back();
+      if (journal_ != nullptr) {
+        journal_->Append(turn_, action);
+      }
     } else {
-      action.reset(sprite->GetAction(game_state_));
+      action = sprite->GetAction(game_state_, &game_state_.rng);
     }
-    // Bind and execute the action and advance the sprite index.
+    // Execute the action and its alternates and advance the sprite index.
     ActionResult result;
-    while (action != nullptr) {
-      action->Bind(sprite, &game_state_, &handler_);
-      result = action->Execute();
+    while (action.type != ActionType::NONE) {
+      result = action.Execute(sprite, &game_state_, &handler_);
       if (result.stalled) {
         // Stalled actions should not return alternates. They will not be executed.
-        ASSERT(result.alternate == nullptr);
-        changed = true;
+        ASSERT(result.alternate.type == ActionType::NONE);
+        update.changed = true;
         break;
       }
-      action.reset(result.alternate);
+      action = std::move(result.alternate);
     }
     // Using the action costs the sprite energy, unless it was a player action
     // that failed (such as a move into a blocked square).
     if (result.success || !sprite->IsPlayer()) {
       sprite->ConsumeEnergy();
       game_state_.AdvanceSprite();
-      changed = true; 
+      turn_ += 1;
+      update.changed = true; 
     }
   }
 
-  for (auto* input : inputs_) {
-    delete input;
+  changed_ = changed_ || update.changed;
+  if (!update.pending) {
+    inputs_.clear();
+    inputs_.swap(pending_inputs_);
+    game_state_.log.Flush(changed_);
+    updating_ = false;
+    update.changed = changed_;
   }
-  inputs_.clear();
-  game_state_.log.Flush(changed);
-  return changed;
+  return update;
 }
 
 View* Engine::GetView(const Point& size) const {
   return new View(size, game_state_);
 }
 
+StatusView Engine::GetStatus() const {
+  return StatusView{game_state_.player->cur_health(),
+                    game_state_.player->max_health()};
+}
+
 }  // namespace engine
 }  // namespace babel
@@ -8,37 +8,95 @@
 #include "engine/Action.h"
 #include "engine/EventHandler.h"
 #include "engine/GameState.h"
+#include "engine/Journal.h"
 #include "engine/Sprite.h"
 #include "engine/View.h"
 
 namespace babel {
 namespace engine {
 
+struct UpdateResult {
+  // True if the graphics need to be redrawn because something changed.
+  bool changed = false;
+  // True if the update ran out of budget before the player needed input.
+  bool pending = false;
+};
+
 class Engine {
  public:
+  // The default constructor seeds the game with the current time. Two engines
+  // constructed with the same seed and given the same inputs play identically.
   Engine();
-  ~Engine();
+  Engine(uint32_t seed);
+
+  uint32_t GetSeed() const { return seed_; }
+
+  // Replays a journal on a new engine, which has exactly the game state that
+  // the journaled engine had after its last input, and which is journaling.
+  // (The new engine has no event handlers, and views are only built when
+  // they are requested.) Returns nullptr if the journal is corrupt or if the
+  // replay diverges from it. Otherwise, the caller takes ownership of the
+  // new engine.
+  static Engine* Replay(const Journal& journal);
+
+  // Journaling is off by default, since a journal grows with every input.
+  // Once StartJournal is called, every input that the engine consumes is
+  // appended to its journal. It must be called before the first Update.
+  void StartJournal();
+
+  // Returns nullptr if the engine is not journaling.
+  const Journal* GetJournal() const { return journal_.get(); }
+  long long GetNumTurns() const { return turn_; }
 
   // Does NOT take ownership of the input EventHandler.
   void AddEventHandler(EventHandler* handler);
 
-  // Takes ownership of the input Action.
+  // Input that is added while a budgeted update is pending is held back until
+  // that update finishes, and is then consumed by the next update, exactly as
+  // if it had been added after the pending update.
+  void AddInput(const Action& input);
+
+  // Takes ownership of the input Action. Used by the Javascript bindings,
+  // which can only pass actions by pointer.
   void AddInput(Action* input);
 
-  // Runs a single update step. Returns true if the graphics need to be
-  // redrawn because something changed.
+  // Runs sprites' turns until the player needs input. Returns true if the
+  // graphics need to be redrawn because something changed.
   bool Update();
 
+  // Like Update, but stops early, between two turns, once budget_us
+  // microseconds have passed or max_steps turns have been taken (a budget of
+  // 0 is unlimited). If it stops early, the result is pending, and the next
+  // call to either Update method resumes exactly where this one stopped, so
+  // the game plays identically however its updates are sliced.
+  UpdateResult Update(int budget_us, int max_steps);
+
   // Exposed to emscripten bindings but not all the way to Javascript.
   dialog::Dialog* GetDialog() { return game_state_.dialog.get(); }
 
   // The caller takes ownership of the new view.
   View* GetView(const Point& radius) const;
 
+  // Returns just the status part of the view, which is much cheaper to build.
+  StatusView GetStatus() const;
+
  private:
+  const uint32_t seed_;
   GameState game_state_;
   DelegatingEventHandler handler_;
-  std::deque<Action*> inputs_;
+  std::deque<Action> inputs_;
+  // Inputs added while an update is pending, which become inputs_ when it
+  // finishes.
+  std::deque<Action> pending_inputs_;
+  // Null unless StartJournal has been called.
+  std::unique_ptr<Journal> journal_;
+  // The number of turns that sprites have taken.
+  long long turn_ = 0;
+
+  // Set while a budgeted update is pending. The log stays open across the
+  // slices of an update, and changed tracks whether any slice changed it.
+  bool updating_ = false;
+  bool changed_ = false;
 };
 
 }  // namespace engine
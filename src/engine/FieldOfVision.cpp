@@ -1,47 +1,131 @@
 #include "engine/FieldOfVision.h"
 
-#include <iostream>
-
-#include "permissive-fov.cc"
-#include "permissive-fov-cpp.h"
+#include <cstdlib>
+#include <vector>
 
 #include "base/debug.h"
-
-using std::vector;
+#include "engine/PermissiveFov.h"
+#include "engine/ShadowcastingFov.h"
 
 namespace babel {
 namespace engine {
 
-FieldOfVision::FieldOfVision(
-    const TileMap& map, const Point& source, int bound)
-    : map_(map), source_(source), offset_(source - Point(bound, bound)),
-      size_(2*bound + 1), is_square_visible_(size_, vector<bool>(size_)) {
-  permissive::squareFov<FieldOfVision>(source_.x, source_.y, bound, *this);
+namespace {
+
+// Handing quadrants to other threads costs tens of microseconds, so smaller
+// fields of vision are computed on the calling thread.
+static const int kMinParallelRadius = 32;
+
+}  // namespace
+
+// Visits the squares in one quadrant into that quadrant's own bit grid, so
+// that quadrants computed at the same time never write to the same word.
+class FieldOfVision::QuadrantVisitor {
+ public:
+  QuadrantVisitor(const FieldOfVision& vision, BitGrid* visible)
+      : vision_(vision), visible_(visible) {}
+
+  bool IsBlocked(const Point& square) const {
+    return vision_.IsBlocked(square);
+  }
+
+  void Visit(const Point& square) {
+    const Point offset_square = square - vision_.offset_;
+    ASSERT(visible_->InBounds(offset_square));
+    if (vision_.IsInMask(offset_square)) {
+      visible_->Set(offset_square);
+    }
+  }
+
+ private:
+  const FieldOfVision& vision_;
+  BitGrid* visible_;
+};
+
+FieldOfVision::FieldOfVision(const BitGrid& opacity, const Point& source,
+                             int radius, FovAlgorithm algorithm,
+                             ThreadPool* pool)
+    : opacity_(opacity), source_(source),
+      offset_(source - Point(radius, radius)), radius_(radius),
+      algorithm_(algorithm), mask_(GetVisionMask(radius)),
+      visible_(Point(2*radius + 1, 2*radius + 1)) {
+  Compute(pool);
+}
+
+bool FieldOfVision::UpdateSquare(const Point& square, bool was_blocked) {
+  const Point diff = square - source_;
+  if (IsBlocked(square) == was_blocked || diff.zero() ||
+      abs(diff.x) > radius_ || abs(diff.y) > radius_) {
+    return false;
+  }
+  if (algorithm_ != PERMISSIVE) {
+    visible_.Clear();
+    Compute(nullptr);
+    return true;
+  }
+  // The scan only checks whether a square is blocked when it visits it, so
+  // a hidden square cannot affect the result. Squares on the axes are checked
+  // by both quadrants that contain them but visited by only one, and squares
+  // outside the mask are never marked visible, so those are recomputed.
+  const Point offset_square = square - offset_;
+  if (diff.x != 0 && diff.y != 0 && IsInMask(offset_square) &&
+      !visible_.Get(offset_square)) {
+    return false;
+  }
+  const Point quadrants[] = {Point(1, 1), Point(-1, 1),
+                             Point(-1, -1), Point(1, -1)};
+  for (const Point& quadrant : quadrants) {
+    if (diff.x*quadrant.x < 0 || diff.y*quadrant.y < 0) {
+      continue;
+    }
+    // Clear the squares that this quadrant visits, then visit them again.
+    const bool owns_x_axis = quadrant.x*quadrant.y == 1;
+    for (int x = owns_x_axis ? 1 : 0; x <= radius_; x++) {
+      for (int y = owns_x_axis ? 0 : 1; y <= radius_; y++) {
+        visible_.Reset(source_ - offset_ + Point(x*quadrant.x, y*quadrant.y));
+      }
+    }
+    gPermissiveFov.ComputeQuadrant(source_, quadrant, radius_, this);
+  }
+  return true;
 }
 
-bool FieldOfVision::IsSquareVisible(const Point& square, float radius) const {
-  Point offset_square = square - offset_;
-  if (0 <= offset_square.x && offset_square.x < size_ &&
-      0 <= offset_square.y && offset_square.y < size_) {
-    return (is_square_visible_[offset_square.x][offset_square.y] &&
-            (square - source_).length() < radius);
+void FieldOfVision::Compute(ThreadPool* pool) {
+  if (algorithm_ == RECURSIVE_SHADOWCASTING) {
+    RecursiveShadowcastingFov().Compute(source_, radius_, this);
+  } else if (algorithm_ == SYMMETRIC_SHADOWCASTING) {
+    SymmetricShadowcastingFov().Compute(source_, radius_, this);
+  } else if (pool != nullptr && pool->GetNumThreads() > 1 &&
+             radius_ >= kMinParallelRadius) {
+    // Each task scans with its own thread's PermissiveFov. Quadrants visit
+    // disjoint sets of squares, so merging them is a plain union.
+    const Point quadrants[] = {Point(1, 1), Point(-1, 1),
+                               Point(-1, -1), Point(1, -1)};
+    std::vector<BitGrid> parts(4, BitGrid(visible_.GetSize()));
+    pool->Run(4, [this, &quadrants, &parts](int i) {
+      QuadrantVisitor visitor(*this, &parts[i]);
+      gPermissiveFov.ComputeQuadrant(source_, quadrants[i], radius_, &visitor);
+    });
+    for (const BitGrid& part : parts) {
+      visible_.Or(part, Point(0, 0));
+    }
+  } else {
+    gPermissiveFov.Compute(source_, radius_, this);
   }
-  return false;
 }
 
-bool FieldOfVision::isBlocked(int x, int y) const {
-  return map_.IsSquareBlocked(Point(x, y));
+bool FieldOfVision::IsBlocked(const Point& square) const {
+  // Out-of-bounds squares are blocked.
+  return !opacity_.InBounds(square) || opacity_.Get(square);
 }
 
-void FieldOfVision::visit(int x, int y) {
-  // Visibility should never extend outside more than one square outside the
-  // field of vision's bounds, as out-of-bounds squares are blocked.
-  Point offset_square(x - offset_.x, y - offset_.y);
-  ASSERT(-1 <= offset_square.x && offset_square.x <= size_ &&
-         -1 <= offset_square.y && offset_square.y <= size_);
-  if (0 <= offset_square.x && offset_square.x < size_ &&
-      0 <= offset_square.y && offset_square.y < size_) {
-    is_square_visible_[offset_square.x][offset_square.y] = true;
+void FieldOfVision::Visit(const Point& square) {
+  // Visibility should never extend outside the field of vision's bounds, as
+  // the scan stops at the radius.
+  const Point offset_square = square - offset_;
+  ASSERT(visible_.InBounds(offset_square));
+  if (IsInMask(offset_square)) {
+    visible_.Set(offset_square);
   }
 }
 
@@ -1,32 +1,82 @@
 #ifndef __BABEL_ENGINE_FIELD_OF_VISION_H__
 #define __BABEL_ENGINE_FIELD_OF_VISION_H__
 
-#include <vector>
-
+#include "base/bit_grid.h"
 #include "base/point.h"
-#include "engine/TileMap.h"
+#include "base/thread_pool.h"
+#include "engine/VisionMask.h"
 
 namespace babel {
 namespace engine {
 
+// Field-of-vision backends. Permissive FOV is exact and symmetric, and the
+// incremental updates and visibility indices built on FieldOfVision rely on
+// that. The shadowcasting backends are faster approximations, for callers
+// that can live with a few squares of difference (see ShadowcastingFov.h).
+enum FovAlgorithm {
+  PERMISSIVE = 0,
+  RECURSIVE_SHADOWCASTING = 1,
+  SYMMETRIC_SHADOWCASTING = 2
+};
+
 class FieldOfVision {
  public:
-  // Computes field-of-vision from the given a tile map and a source point.
-  // Squares that are more than bound away in x- or y-coordinate are hidden.
-  FieldOfVision(const TileMap& tiles, const Point& source, int bound);
+  // Computes field-of-vision from the given source point. opacity has a set
+  // bit for each blocked square on the map, and must outlive this object.
+  // Squares outside the radius's vision mask, which are those radius or more
+  // away from the source, are hidden.
+  //
+  // If a thread pool is given, large permissive fields of vision are computed
+  // one quadrant per task, and each quadrant is merged in once all are done.
+  // The pool is only used during construction.
+  FieldOfVision(const BitGrid& opacity, const Point& source, int radius,
+                FovAlgorithm algorithm=PERMISSIVE, ThreadPool* pool=nullptr);
+
+  bool IsSquareVisible(const Point& square) const {
+    const Point offset_square = square - offset_;
+    return visible_.InBounds(offset_square) && visible_.Get(offset_square);
+  }
 
-  bool IsSquareVisible(const Point& square, float radius) const;
+  // Visibility is stored as a bit grid covering the square of side length
+  // 2*radius + 1 around the source. Its (0, 0) is at GetOffset on the map.
+  const BitGrid& GetVisibleSquares() const { return visible_; }
+  const Point& GetOffset() const { return offset_; }
 
-  // Interface methods needed to use this class with the permissive-fov library.
-  bool isBlocked(int x, int y) const;
-  void visit(int x, int y);
+  // Updates the field of vision after the tile at the given square changed.
+  // Only the quadrants that contain the square are recomputed, and only if the
+  // change could affect them: the square must have been visible (or on one of
+  // the source's axes) and must have become blocked or unblocked. Returns true
+  // if any squares were recomputed. Fields of vision computed by other
+  // algorithms are recomputed in full if the square is within the radius.
+  bool UpdateSquare(const Point& square, bool was_blocked);
+
+  // Interface methods needed to use this class with the FOV backends.
+  bool IsBlocked(const Point& square) const;
+  void Visit(const Point& square);
 
  private:
-  const TileMap& map_;
+  class QuadrantVisitor;
+
+  void Compute(ThreadPool* pool);
+
+  // Takes a square relative to offset_, which must be in visible_'s bounds.
+  bool IsInMask(const Point& square) const {
+    if (mask_ == nullptr) {
+      const Point diff = square - Point(radius_, radius_);
+      return diff.x*diff.x + diff.y*diff.y < radius_*radius_;
+    }
+    return (mask_[square.y] >> square.x) & 1;
+  }
+
+  const BitGrid& opacity_;
   const Point source_;
   const Point offset_;
-  const int size_;
-  std::vector<std::vector<bool>> is_square_visible_;
+  const int radius_;
+  const FovAlgorithm algorithm_;
+  // The vision mask for radius_, with the same layout as visible_, or null
+  // if the radius is too large to have one.
+  const uint64_t* mask_;
+  BitGrid visible_;
 };
 
 }  // namespace engine
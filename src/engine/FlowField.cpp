@@ -0,0 +1,87 @@
+#include "engine/FlowField.h"
+
+#include "base/debug.h"
+
+using std::vector;
+
+namespace babel {
+namespace engine {
+
+namespace {
+
+// Must be a power of two greater than the largest step cost.
+static const int kNumBuckets = 8;
+static_assert(kNumBuckets > FlowField::kDiagonalCost + FlowField::kDoorCost,
+              "Steps must not wrap around the bucket ring.");
+
+bool IsWalkable(Tile tile) {
+  return tile == Tile::FREE || tile == Tile::DOOR || tile == Tile::FENCE;
+}
+
+}  // namespace
+
+const int FlowField::kOrthogonalCost;
+const int FlowField::kDiagonalCost;
+const int FlowField::kDoorCost;
+const int FlowField::kUnreachable;
+
+FlowField::FlowField(const TileMap& map, int max_distance)
+    : map_(map), size_(map.GetSize()), max_distance_(max_distance),
+      distances_(size_.x*size_.y, kUnreachable), buckets_(kNumBuckets),
+      num_open_(0) {}
+
+void FlowField::Compute(const vector<Point>& sources) {
+  for (int index : reached_) {
+    distances_[index] = kUnreachable;
+  }
+  reached_.clear();
+  for (const Point& source : sources) {
+    if (InBounds(source) && IsWalkable(map_.GetTile(source))) {
+      Relax(Index(source), 0);
+    }
+  }
+
+  for (int distance = 0; num_open_ > 0; distance++) {
+    vector<int>& bucket = buckets_[distance & (kNumBuckets - 1)];
+    // Relaxing a square never adds to the bucket being drained, since every
+    // step costs at least 1.
+    for (int index : bucket) {
+      num_open_ -= 1;
+      if (distances_[index] != distance) {
+        continue;
+      }
+      const Point square(index/size_.y, index % size_.y);
+      const bool door = map_.GetTile(square) != Tile::FREE;
+      Point step;
+      for (step.x = -1; step.x <= 1; step.x++) {
+        for (step.y = -1; step.y <= 1; step.y++) {
+          const Point neighbor = square + step;
+          if (step.zero() || !InBounds(neighbor) ||
+              !IsWalkable(map_.GetTile(neighbor))) {
+            continue;
+          }
+          const int cost = (step.x != 0 && step.y != 0 ?
+                            kDiagonalCost : kOrthogonalCost);
+          Relax(Index(neighbor), distance + cost + (door ? kDoorCost : 0));
+        }
+      }
+    }
+    bucket.clear();
+  }
+  ASSERT(num_open_ == 0);
+}
+
+void FlowField::Relax(int index, int distance) {
+  if (distance > max_distance_ || distance >= distances_[index]) {
+    return;
+  }
+  if (distances_[index] == kUnreachable) {
+    reached_.push_back(index);
+  }
+  distances_[index] = distance;
+  buckets_[distance & (kNumBuckets - 1)].push_back(index);
+  num_open_ += 1;
+}
+
+}  // namespace engine
+}  // namespace babel
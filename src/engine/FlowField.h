@@ -0,0 +1,72 @@
+// FlowField is a Dijkstra map: the walking distance from every square to the
+// nearest of a set of source squares. GameState keeps one toward the player,
+// which it recomputes when the player moves or the map changes, so that every
+// NPC chasing the player picks its next step by looking up its neighbors'
+// distances instead of searching on its own.
+//
+// The field is 8-connected. Orthogonal steps cost 2 and diagonal steps cost 3,
+// so that among paths of the same number of turns, the straightest is the
+// shortest. Closed doors and fences are walkable, but stepping off of one
+// costs kDoorCost more, for the turn it takes to open it. Sprites are ignored,
+// as they move far more often than the field is recomputed.
+
+#ifndef __BABEL_ENGINE_FLOW_FIELD_H__
+#define __BABEL_ENGINE_FLOW_FIELD_H__
+
+#include <climits>
+#include <vector>
+
+#include "base/point.h"
+#include "engine/TileMap.h"
+
+namespace babel {
+namespace engine {
+
+class FlowField {
+ public:
+  static const int kOrthogonalCost = 2;
+  static const int kDiagonalCost = 3;
+  static const int kDoorCost = 2;
+  static const int kUnreachable = INT_MAX;
+
+  // Does NOT take ownership of the map, which must outlive the field. Squares
+  // further than max_distance from every source are left unreachable, which
+  // bounds the cost of each computation on large maps.
+  FlowField(const TileMap& map, int max_distance);
+
+  // Recomputes distances from the given sources. Only the squares reached by
+  // the last computation are reset, so this does no work proportional to the
+  // size of the map.
+  void Compute(const std::vector<Point>& sources);
+
+  // Returns kUnreachable for squares that are blocked, out of bounds, or
+  // further than max_distance from every source.
+  int GetDistance(const Point& square) const {
+    return InBounds(square) ? distances_[Index(square)] : kUnreachable;
+  }
+
+ private:
+  bool InBounds(const Point& square) const {
+    return (0 <= square.x && square.x < size_.x &&
+            0 <= square.y && square.y < size_.y);
+  }
+  // Distances are laid out like TileMap's tiles.
+  int Index(const Point& square) const { return square.x*size_.y + square.y; }
+
+  void Relax(int index, int distance);
+
+  const TileMap& map_;
+  const Point size_;
+  const int max_distance_;
+  std::vector<int> distances_;
+  std::vector<int> reached_;
+  // Step costs are small integers, so the open set is a ring of buckets, one
+  // per distance, with enough buckets to hold the largest step ahead.
+  std::vector<std::vector<int>> buckets_;
+  int num_open_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_FLOW_FIELD_H__
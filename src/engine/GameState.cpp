@@ -5,6 +5,7 @@
 
 #include "base/creature.h"
 #include "base/debug.h"
+#include "base/thread_pool.h"
 #include "base/util.h"
 #include "dialog/dialogs.h"
 #include "dialog/traps.h"
@@ -22,31 +23,84 @@ namespace {
 
 const Point kMapSize(48, 24);
 
+// The number of recent player fields of vision to cache.
+const int kVisionCacheSize = 16;
+
+// The number of recent line-of-sight answers to cache.
+const int kLineOfSightCacheSize = 256;
+
+// NPCs only chase the player once they see them, so paths to the player are
+// rarely much longer than a vision radius. This bound is in FlowField's units,
+// where an orthogonal step costs 2.
+const int kMaxFlowDistance = 128;
+
+// Levels are generated without light sources, so they are lit throughout.
+const int kAmbientLight = 1;
+
+// Returns the vision radius that the most NPC creature types share. The
+// potentially visible set is built for it, so that most NPCs' sight checks
+// are lookups.
+int GetCommonVisionRadius() {
+  std::map<int,int> counts;
+  for (int i = 0; i < (int)kCreatures.size(); i++) {
+    if (i != mPlayer) {
+      counts[kCreatures[i].stats.vision_radius] += 1;
+    }
+  }
+  int result = 0;
+  int best = 0;
+  for (const auto& pair : counts) {
+    if (pair.second > best) {
+      result = pair.first;
+      best = pair.second;
+    }
+  }
+  ASSERT(best > 0);
+  return result;
+}
+
 }  // namespace
 
-GameState::GameState(const string& map_file) {
-  map.reset(new gen::RoomAndCorridorMap(kMapSize));
-  seen = vector<vector<bool>>(
-      map->GetSize().x, vector<bool>(map->GetSize().y, false));
-  player = new Sprite(map->GetStartingSquare(), mPlayer);
-  AddNPC(player);
+GameState::GameState(const string& map_file, uint32_t seed)
+    : player_vision(nullptr), rng(seed), map_version_(0),
+      vision_cache_(kVisionCacheSize), player_vision_key_(),
+      line_of_sight_(opacity_, kLineOfSightCacheSize),
+      sprite_vision_(opacity_, GetSharedThreadPool()),
+      player_flow_version_(-1) {
+  map.reset(new gen::RoomAndCorridorMap(kMapSize, &rng));
+  opacity_ = BitGrid(map->GetSize());
+  for (int x = 0; x < map->GetSize().x; x++) {
+    for (int y = 0; y < map->GetSize().y; y++) {
+      if (map->IsSquareBlocked(Point(x, y))) {
+        opacity_.Set(Point(x, y));
+      }
+    }
+  }
+  occupancy.reset(new OccupancyGrid(*map));
+  spatial_index_.reset(new SpatialIndex(map->GetSize()));
+  lights.reset(new LightMap(opacity_));
+  player_flow_.reset(new FlowField(*map, kMaxFlowDistance));
+  pathfinder_.reset(new Pathfinder(*map));
+  lights->SetAmbientLight(kAmbientLight);
+  seen = BitGrid(map->GetSize());
+  player = AddNPC(map->GetStartingSquare(), mPlayer);
   RecomputePlayerVision();
 
   // TODO(skishore): Don't assume that the player starts in room 0.
   for (int i = 1; i < map->GetRooms().size(); i++) {
     const TileMap::Room& room = map->GetRooms()[i];
     // Decide whether to spawn a trap or a group of enemies in this room.
-    const bool trapped = rand() % 2 == 0;
+    const bool trapped = rng.Uniform(2) == 0;
     if (trapped) {
       AddTrap(new dialog::DialogGroupTrap(room.squares));
       continue;
     }
-    const int num_enemies = (rand() % 3) + 2;
+    const int num_enemies = rng.Uniform(3) + 2;
     for (int j = 0; j < num_enemies; j++) {
       for (int tries = 0; tries < 10; tries++) {
-        const Point square = room.GetRandomSquare();
+        const Point square = room.GetRandomSquare(&rng);
         if (!IsSquareOccupied(square)) {
-          AddNPC(new Sprite(square, mGecko));
+          AddNPC(square, mGecko);
           break;
         }
       }
@@ -55,32 +109,43 @@ GameState::GameState(const string& map_file) {
 }
 
 GameState::~GameState() {
-  for (Sprite* sprite : sprites) {
-    delete sprite;
+  for (Trap* trap : traps) {
+    delete trap;
   }
 }
 
-void GameState::AddNPC(Sprite* sprite) {
-  ASSERT(sprite != nullptr);
-  ASSERT(!IsSquareOccupied(sprite->square));
-  sprites.push_back(sprite);
-  sprite_positions[sprite->square] = sprite;
+Sprite* GameState::AddNPC(const Point& square, int type, bool exhausted) {
+  ASSERT(!IsSquareOccupied(square));
+  int energy = kEnergyNeededToMove;
+  if (type != mPlayer) {
+    energy = rng.Uniform(kEnergyNeededToMove);
+  }
+  if (exhausted) {
+    energy -= kEnergyNeededToMove;
+  }
+  Sprite* sprite = sprites.Add(square, type, energy);
+  occupancy->AddSprite(square, sprite->Id());
+  spatial_index_->AddSprite(square, sprite->Id());
+  scheduler.AddSprite(sprite);
+  if (!sprite->IsPlayer()) {
+    sprite_vision_.MarkStale(sprite->Id());
+  }
+  return sprite;
 }
 
 void GameState::RemoveNPC(Sprite* sprite) {
   ASSERT(sprite != nullptr);
   ASSERT(!sprite->IsPlayer());
-  const auto& it = remove(sprites.begin(), sprites.end(), sprite);
-  const int index = it - sprites.begin();
-  sprites.erase(it, sprites.end());
-  sprite_positions.erase(sprite->square);
-  delete sprite;
-  // Update the current-sprite index, if necessary.
-  if (sprite_index > index) {
-    sprite_index -= 1;
-  } else if (sprite_index == index) {
-    sprite_index = sprite_index % sprites.size();
-  }
+  occupancy->RemoveSprite(sprite->square());
+  spatial_index_->RemoveSprite(sprite->square());
+  scheduler.RemoveSprite(sprite);
+  SetSpriteLight(sprite, 0);
+  sprite_vision_.Remove(sprite->Id());
+  sprites.Remove(sprite->Id());
+}
+
+Sprite* GameState::GetSprite(sid id) const {
+  return sprites.Get(id);
 }
 
 void GameState::MoveSprite(const Point& move, Sprite* sprite) {
@@ -88,15 +153,23 @@ void GameState::MoveSprite(const Point& move, Sprite* sprite) {
     return;
   }
   ASSERT(sprite != nullptr);
-  ASSERT(sprite_positions[sprite->square] == sprite);
-  Point new_square = sprite->square + move;
+  ASSERT(SpriteAt(sprite->square()) == sprite);
+  Point new_square = sprite->square() + move;
   ASSERT(!IsSquareOccupied(new_square));
-  sprite_positions.erase(sprite->square);
-  sprite_positions[new_square] = sprite;
-  sprite->square = new_square;
+  occupancy->MoveSprite(sprite->square(), new_square);
+  spatial_index_->MoveSprite(sprite->square(), new_square);
+  sprites.squares[sprite->index_] = new_square;
 
   if (sprite == player) {
     RecomputePlayerVision();
+  } else {
+    sprite_vision_.MarkStale(sprite->Id());
+  }
+  if (!sprite_lights_.empty()) {
+    const auto& it = sprite_lights_.find(sprite->Id());
+    if (it != sprite_lights_.end()) {
+      lights->MoveLight(it->second, new_square);
+    }
   }
 }
 
@@ -131,20 +204,88 @@ void GameState::MaybeTriggerTrap(const Point& square, EventHandler* handler) {
 }
 
 Sprite* GameState::GetCurrentSprite() const {
-  return sprites[sprite_index];
+  return scheduler.GetCurrentSprite();
 }
 
 void GameState::AdvanceSprite() {
-  ASSERT(sprites.size() > 0);
-  sprite_index = (sprite_index + 1) % sprites.size();
+  scheduler.AdvanceSprite();
+}
+
+void GameState::SetTile(const Point& square, Tile tile) {
+  const bool was_blocked = map->IsSquareBlocked(square);
+  map->SetTile(square, tile);
+  if (!opacity_.InBounds(square)) {
+    return;
+  } else if (map->IsSquareBlocked(square)) {
+    opacity_.Set(square);
+  } else {
+    opacity_.Reset(square);
+  }
+  occupancy->UpdateTile(square);
+  line_of_sight_.UpdateTile(square);
+  sprite_vision_.UpdateTile(square, was_blocked);
+  lights->UpdateTile(square, was_blocked);
+  if (pvs_ != nullptr) {
+    pvs_->UpdateTile(square, map->IsSquareBlocked(square));
+  }
+  if (hierarchical_pathfinder_ != nullptr) {
+    hierarchical_pathfinder_->UpdateTile(square);
+  }
+  map_version_ += 1;
+
+  // Carry the player's field of vision over to the new map version. Cached
+  // fields of vision for older versions are never hit again and age out.
+  FieldOfVision* vision = vision_cache_.Release(player_vision_key_);
+  if (vision == nullptr) {
+    return;
+  }
+  player_vision_key_.map_version = map_version_;
+  if (vision->UpdateSquare(square, was_blocked)) {
+    seen.Or(vision->GetVisibleSquares(), vision->GetOffset());
+  }
+  vision_cache_.Set(player_vision_key_, vision);
 }
 
 bool GameState::IsSquareOccupied(const Point& square) const {
-  return sprite_positions.find(square) != sprite_positions.end();
+  return occupancy->SpriteAt(square) != kInvalidSid;
 }
 
 Sprite* GameState::SpriteAt(const Point& square) const {
-  return sprite_positions.at(square);
+  Sprite* sprite = GetSprite(occupancy->SpriteAt(square));
+  ASSERT(sprite != nullptr);
+  return sprite;
+}
+
+bool GameState::IsSquareBlockedOrOccupied(const Point& square) const {
+  return occupancy->IsSquareBlockedOrOccupied(square);
+}
+
+void GameState::GetSpritesInRadius(const Point& center, int radius,
+                                   vector<Sprite*>* result) const {
+  spatial_index_->GetSpritesInRadius(center, radius, &spatial_ids_);
+  GetSpritesFromIds(spatial_ids_, result);
+}
+
+void GameState::GetSpritesInRect(const Point& position, const Point& size,
+                                 vector<Sprite*>* result) const {
+  spatial_index_->GetSpritesInRect(position, size, &spatial_ids_);
+  GetSpritesFromIds(spatial_ids_, result);
+}
+
+void GameState::GetNearestSprites(const Point& center, int k,
+                                  vector<Sprite*>* result) const {
+  spatial_index_->GetNearestSprites(center, k, &spatial_ids_);
+  GetSpritesFromIds(spatial_ids_, result);
+}
+
+void GameState::GetSpritesFromIds(const vector<sid>& ids,
+                                  vector<Sprite*>* result) const {
+  result->clear();
+  for (sid id : ids) {
+    Sprite* sprite = GetSprite(id);
+    ASSERT(sprite != nullptr);
+    result->push_back(sprite);
+  }
 }
 
 bool GameState::IsSquareTrapped(const Point& square) const {
@@ -155,27 +296,84 @@ Trap* GameState::TrapAt(const Point& square) const {
   return trap_positions.at(square);
 }
 
-bool GameState::IsSquareSeen(const Point& square) const {
-  if (0 <= square.x && square.x < map->GetSize().x &&
-      0 <= square.y && square.y < map->GetSize().y) {
-    return seen[square.x][square.y];
+bool GameState::CanSpriteSee(const Sprite& sprite, const Point& square) const {
+  ASSERT(!sprite.IsPlayer());
+  const Point diff = square - sprite.square();
+  const int radius = sprite.vision_radius();
+  if (!IsInVisionMask(radius, diff)) {
+    return false;
+  }
+  if (pvs_ == nullptr) {
+    pvs_.reset(new PotentiallyVisibleSet(opacity_, GetCommonVisionRadius()));
+  }
+  if (pvs_->GetRadius() == radius && pvs_->HasSource(sprite.square())) {
+    return pvs_->IsSquareVisible(sprite.square(), square);
   }
-  return false;
+  return HasLineOfSight(sprite.square(), square);
+}
+
+void GameState::SetSpriteLight(Sprite* sprite, int radius) {
+  ASSERT(sprite != nullptr);
+  const auto& it = sprite_lights_.find(sprite->Id());
+  if (it != sprite_lights_.end()) {
+    lights->RemoveLight(it->second);
+    sprite_lights_.erase(it);
+  }
+  if (radius > 0) {
+    sprite_lights_[sprite->Id()] =
+        lights->AddLight(sprite->square(), radius);
+  }
+}
+
+const FlowField& GameState::GetPlayerFlowField() const {
+  if (player_flow_version_ != map_version_ ||
+      player_flow_source_ != player->square()) {
+    player_flow_->Compute({player->square()});
+    player_flow_source_ = player->square();
+    player_flow_version_ = map_version_;
+  }
+  return *player_flow_;
+}
+
+bool GameState::FindPath(const Point& source, const Point& target,
+                         const MoveCosts& costs, vector<Point>* path) const {
+  return pathfinder_->FindPath(source, target, costs, path);
+}
+
+bool GameState::FindLongPath(const Point& source, const Point& target,
+                             vector<Point>* path) const {
+  if (hierarchical_pathfinder_ == nullptr) {
+    hierarchical_pathfinder_.reset(
+        new HierarchicalPathfinder(*map, kDefaultMoveCosts));
+  }
+  return hierarchical_pathfinder_->FindPath(source, target, path);
+}
+
+bool GameState::HasLineOfSight(const Point& a, const Point& b) const {
+  return line_of_sight_.IsVisible(a, b);
+}
+
+const FieldOfVision& GameState::GetSpriteVision(const Sprite& sprite) const {
+  ASSERT(!sprite.IsPlayer());
+  if (!sprite_vision_.IsCurrent(sprites, sprite.Id())) {
+    sprite_vision_.MarkStale(sprite.Id());
+    sprite_vision_.UpdateNear(sprites, sprite.square());
+  }
+  return sprite_vision_.Get(sprite.Id());
 }
 
 void GameState::RecomputePlayerVision() {
-  const int radius = player->creature->stats.vision_radius;
-  player_vision.reset(new FieldOfVision(*map, player->square, radius));
-  for (int x = -radius; x <= radius; x++) {
-    for (int y = -radius; y <= radius; y++) {
-      const Point square = player->square + Point(x, y);
-      if (0 <= square.x && square.x < seen.size() &&
-          0 <= square.y && square.y < seen[square.x].size() &&
-          player_vision->IsSquareVisible(square, radius)) {
-        seen[square.x][square.y] = true;
-      }
-    }
+  const VisionKey key{player->square(), player->vision_radius(), map_version_};
+  FieldOfVision* vision = vision_cache_.Get(key);
+  if (vision == nullptr) {
+    vision = new FieldOfVision(opacity_, key.source, key.radius);
+    vision_cache_.Set(key, vision);
+    // Squares are marked as seen only when a field of vision is computed, so
+    // cache hits skip this.
+    seen.Or(vision->GetVisibleSquares(), vision->GetOffset());
   }
+  player_vision = vision;
+  player_vision_key_ = key;
 }
 
 }  // namespace engine
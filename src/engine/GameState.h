@@ -5,18 +5,37 @@
 // game engine should enforce this logic. However, it does throw an assertion
 // error if the sprite moves onto another sprite's square, because this
 // would violate the data structure's integrity.
+//
+// Tiles must be changed through GameState's SetTile, rather than through the
+// map directly, so that the indices built on top of the map stay in sync.
 
 #ifndef __BABEL_ENGINE_GAME_STATE_H__
 #define __BABEL_ENGINE_GAME_STATE_H__
 
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
+#include "base/bit_grid.h"
+#include "base/lru_cache.h"
 #include "base/point.h"
+#include "base/rng.h"
 #include "engine/FieldOfVision.h"
+#include "engine/FlowField.h"
+#include "engine/HierarchicalPathfinder.h"
+#include "engine/LightMap.h"
+#include "engine/LineOfSight.h"
 #include "engine/Log.h"
+#include "engine/OccupancyGrid.h"
+#include "engine/Pathfinder.h"
+#include "engine/PotentiallyVisibleSet.h"
+#include "engine/Scheduler.h"
+#include "engine/SpatialIndex.h"
+#include "engine/Sprite.h"
+#include "engine/SpriteStore.h"
+#include "engine/SpriteVision.h"
 #include "engine/TileMap.h"
 #include "engine/Trap.h"
 
@@ -29,18 +48,22 @@ class Dialog;
 namespace engine {
 
 class EventHandler;
-class Sprite;
 
 class GameState {
  public:
-  GameState(const std::string& map_file);
+  // All randomness in the game is drawn from an RNG with the given seed.
+  GameState(const std::string& map_file, uint32_t seed);
   ~GameState();
 
-  // AddNPC takes ownership of the new sprite.
-  void AddNPC(Sprite* sprite);
+  // AddNPC creates and schedules a new sprite. An exhausted sprite starts
+  // out a turn behind. RemoveNPC deletes the sprite, so its id becomes stale.
+  Sprite* AddNPC(const Point& square, int type, bool exhausted=false);
   void RemoveNPC(Sprite* sprite);
   void MoveSprite(const Point& move, Sprite* sprite);
 
+  // Returns nullptr if the id is stale.
+  Sprite* GetSprite(sid id) const;
+
   // AddTrap takes ownership of the new trap.
   void AddTrap(Trap* trap);
   void RemoveTrap(Trap* trap);
@@ -49,28 +72,141 @@ class GameState {
   Sprite* GetCurrentSprite() const;
   void AdvanceSprite();
 
+  void SetTile(const Point& square, Tile tile);
+
   bool IsSquareOccupied(const Point& square) const;
   Sprite* SpriteAt(const Point& square) const;
 
+  // Equivalent to checking map->IsSquareBlocked and IsSquareOccupied, but it
+  // only does a single lookup.
+  bool IsSquareBlockedOrOccupied(const Point& square) const;
+
+  // Proximity queries over all sprites, including the player. See
+  // SpatialIndex for the exact semantics. Each clears its result first.
+  void GetSpritesInRadius(const Point& center, int radius,
+                          std::vector<Sprite*>* result) const;
+  void GetSpritesInRect(const Point& position, const Point& size,
+                        std::vector<Sprite*>* result) const;
+  void GetNearestSprites(const Point& center, int k,
+                         std::vector<Sprite*>* result) const;
+
   bool IsSquareTrapped(const Point& square) const;
   Trap* TrapAt(const Point& square) const;
 
-  bool IsSquareSeen(const Point& square) const;
+  bool IsSquareSeen(const Point& square) const {
+    return seen.InBounds(square) && seen.Get(square);
+  }
+
+  // Recent fields of vision are cached by source, radius, and map version, so
+  // this method is free if the player returns to a square they recently saw
+  // the map from. SetTile updates the player's field of vision in place.
   void RecomputePlayerVision();
 
+  // Incremented each time a tile changes.
+  int GetMapVersion() const { return map_version_; }
+
+  // Returns true if the NPC can see the square from where it stands, with its
+  // own vision radius. NPCs with the vision radius that most creatures share
+  // are answered from a potentially visible set, which is built on the first
+  // call and then kept up to date; others fall back to HasLineOfSight.
+  // Queries for squares out of range are free.
+  bool CanSpriteSee(const Sprite& sprite, const Point& square) const;
+
+  // Returns true if each square is visible from the other at any distance,
+  // consistent with FieldOfVision. Answers are cached until a tile between
+  // the two squares changes.
+  bool HasLineOfSight(const Point& a, const Point& b) const;
+
+  // Returns the NPC's whole field of vision, for AI that needs more than a
+  // few squares of it. NPC fields of vision are computed lazily, in batches:
+  // a call recomputes the stale fields of vision of every NPC near enough to
+  // see the NPC's square. The result is valid until the NPC next moves.
+  const FieldOfVision& GetSpriteVision(const Sprite& sprite) const;
+
+  // Walking distances to the player, shared by every NPC chasing them. The
+  // field is recomputed on the first call after the player moves or a tile
+  // changes, and only covers squares within a bounded distance.
+  const FlowField& GetPlayerFlowField() const;
+
+  // Finds a cheapest path for a creature with the given movement costs. See
+  // Pathfinder::FindPath. Sprites are ignored, so the path may be occupied.
+  bool FindPath(const Point& source, const Point& target,
+                const MoveCosts& costs, std::vector<Point>* path) const;
+
+  // Equivalent to FindPath with kDefaultMoveCosts, but plans over the graph of
+  // rooms and corridors first, so it is much faster across a large level.
+  // The graph is built on the first call, and then kept up to date.
+  bool FindLongPath(const Point& source, const Point& target,
+                    std::vector<Point>* path) const;
+
+  // The player sees the squares in their field of vision that are lit.
+  bool CanPlayerSee(const Point& square) const {
+    return (player_vision->IsSquareVisible(square) &&
+            lights->IsSquareLit(square));
+  }
+
+  // Attaches a light with the given radius to the sprite, replacing any light
+  // it already carries. The light moves with the sprite, and is removed with
+  // it. A radius of 0 removes the sprite's light.
+  void SetSpriteLight(Sprite* sprite, int radius);
+
   Sprite* player;
-  std::vector<Sprite*> sprites;
+  // Sprites are stored densely, as columns, in an unstable order.
+  SpriteStore sprites;
   std::unique_ptr<TileMap> map;
-  std::unique_ptr<FieldOfVision> player_vision;
+  // Fixed lights, like torches, are added to the light map directly. Its
+  // ambient level is positive by default, so every square is lit.
+  std::unique_ptr<LightMap> lights;
+  // Owned by the vision cache.
+  FieldOfVision* player_vision;
   std::unique_ptr<dialog::Dialog> dialog;
   Log log;
+  RNG rng;
 
  private:
-  std::vector<std::vector<bool>> seen;
-  std::unordered_map<Point,Sprite*> sprite_positions;
+  struct VisionKey {
+    Point source;
+    int radius;
+    int map_version;
+
+    bool operator<(const VisionKey& other) const {
+      return std::tie(source.x, source.y, radius, map_version) <
+             std::tie(other.source.x, other.source.y,
+                      other.radius, other.map_version);
+    }
+  };
+
+  // Replaces the result with the sprites with the given ids, none stale.
+  void GetSpritesFromIds(const std::vector<sid>& ids,
+                         std::vector<Sprite*>* result) const;
+
+  // A set bit for each blocked square on the map, which every field of
+  // vision reads. SetTile keeps it in sync.
+  BitGrid opacity_;
+  int map_version_;
+  LRUCache<VisionKey,FieldOfVision> vision_cache_;
+  VisionKey player_vision_key_;
+
+  BitGrid seen;
+  std::unique_ptr<OccupancyGrid> occupancy;
+  std::unique_ptr<SpatialIndex> spatial_index_;
+  // Caches answers for const queries.
+  mutable LineOfSight line_of_sight_;
+  // Updated lazily by const queries.
+  mutable SpriteVision sprite_vision_;
+  std::unique_ptr<FlowField> player_flow_;
+  mutable Point player_flow_source_;
+  mutable int player_flow_version_;
+  std::unique_ptr<Pathfinder> pathfinder_;
+  // Null until the first CanSpriteSee call.
+  mutable std::unique_ptr<PotentiallyVisibleSet> pvs_;
+  // Null until the first FindLongPath call.
+  mutable std::unique_ptr<HierarchicalPathfinder> hierarchical_pathfinder_;
+  mutable std::vector<sid> spatial_ids_;
+  std::unordered_map<sid,LightId> sprite_lights_;
   std::unordered_map<Point,Trap*> trap_positions;
   std::vector<Trap*> traps;
-  int sprite_index = 0;
+  Scheduler scheduler;
 };
 
 }  // namespace engine
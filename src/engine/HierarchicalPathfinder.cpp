@@ -0,0 +1,382 @@
+#include "engine/HierarchicalPathfinder.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+#include "base/debug.h"
+
+using std::vector;
+
+namespace babel {
+namespace engine {
+
+const int HierarchicalPathfinder::kNone;
+
+namespace {
+
+// Corridors are split into blocks of this size, so that searches within one
+// region stay cheap even when corridors merge into a network spanning the map.
+static const int kBlockSize = 16;
+
+bool InSameBlock(const Point& a, const Point& b) {
+  return a.x/kBlockSize == b.x/kBlockSize && a.y/kBlockSize == b.y/kBlockSize;
+}
+
+}  // namespace
+
+HierarchicalPathfinder::HierarchicalPathfinder(
+    const TileMap& map, const MoveCosts& costs)
+    : map_(map), costs_(costs), size_(map.GetSize()), square_generation_(0),
+      node_generation_(0), num_expanded_(0),
+      square_labels_(size_.x*size_.y, Label{0, 0, 0, 0}) {
+  Rebuild();
+}
+
+bool HierarchicalPathfinder::FindPath(
+    const Point& source, const Point& target, vector<Point>* path) {
+  ASSERT(path != nullptr);
+  path->clear();
+  num_expanded_ = 0;
+  const int source_region = GetRegion(source);
+  const int target_region = GetRegion(target);
+  if (source_region == kNone || target_region == kNone) {
+    return false;
+  } else if (source == target) {
+    return true;
+  }
+  NextGeneration(&node_labels_, &node_generation_);
+
+  // Connect the target to the nodes in its region.
+  SearchRegion(target, true /* reverse */);
+  for (int node : region_nodes_[target_region]) {
+    const Label& label = square_labels_[Index(nodes_[node].square)];
+    if (label.generation == square_generation_) {
+      GetLabel(&node_labels_, node_generation_, node).target_cost = label.cost;
+    }
+  }
+
+  // Connect the source to the nodes in its region. The source and target may
+  // be connected within a region, too.
+  int best_cost = INT_MAX;
+  int best_node = kNone;
+  SearchRegion(source, false /* reverse */);
+  if (source_region == target_region) {
+    const Label& label = square_labels_[Index(target)];
+    if (label.generation == square_generation_) {
+      best_cost = label.cost;
+    }
+  }
+  heap_.clear();
+  for (int node : region_nodes_[source_region]) {
+    const Label& square_label = square_labels_[Index(nodes_[node].square)];
+    if (square_label.generation != square_generation_) {
+      continue;
+    }
+    Label& label = GetLabel(&node_labels_, node_generation_, node);
+    label.cost = square_label.cost;
+    label.parent = kNone;
+    Push(label.cost +
+         GetOctileDistance(nodes_[node].square, target, costs_), node);
+  }
+
+  // Search the graph with A*. Entries are skipped if their node was reached
+  // more cheaply after they were pushed.
+  while (!heap_.empty()) {
+    const HeapEntry entry = Pop();
+    const Node& node = nodes_[entry.second];
+    const Label& label = node_labels_[entry.second];
+    const int estimate =
+        label.cost + GetOctileDistance(node.square, target, costs_);
+    if (entry.first != estimate) {
+      continue;
+    } else if (estimate >= best_cost) {
+      break;
+    }
+    num_expanded_ += 1;
+    if (label.target_cost != INT_MAX &&
+        label.cost + label.target_cost < best_cost) {
+      best_cost = label.cost + label.target_cost;
+      best_node = entry.second;
+    }
+    for (const Edge& edge : node.edges) {
+      Label& child = GetLabel(&node_labels_, node_generation_, edge.node);
+      if (label.cost + edge.cost < child.cost) {
+        child.cost = label.cost + edge.cost;
+        child.parent = entry.second;
+        Push(child.cost + GetOctileDistance(
+                 nodes_[edge.node].square, target, costs_), edge.node);
+      }
+    }
+  }
+  if (best_cost == INT_MAX) {
+    return false;
+  }
+
+  // Refine the abstract path. Consecutive nodes in different regions are
+  // adjacent, and those in the same region are joined by a local search.
+  abstract_path_.clear();
+  for (int node = best_node; node != kNone; node = node_labels_[node].parent) {
+    abstract_path_.push_back(node);
+  }
+  Point square = source;
+  for (int i = abstract_path_.size() - 1; i >= 0; i--) {
+    const Point& next = nodes_[abstract_path_[i]].square;
+    if (GetRegion(next) == GetRegion(square)) {
+      AppendRegionPath(square, next, path);
+    } else {
+      path->push_back(next);
+    }
+    square = next;
+  }
+  AppendRegionPath(square, target, path);
+  return true;
+}
+
+void HierarchicalPathfinder::UpdateTile(const Point& square) {
+  if (!InBounds(square)) {
+    return;
+  }
+  const int index = Index(square);
+  const bool walkable = engine::GetStepCost(
+      map_.GetTile(square), false, costs_) != MoveCosts::kImpassable;
+  if (walkable != (regions_[index] != kNone)) {
+    Rebuild();
+    return;
+  } else if (!walkable) {
+    return;
+  }
+  // The cost of stepping onto the square changed, which changes the edges
+  // within its region and the edges onto it from other regions.
+  ComputeRegionEdges(regions_[index]);
+  const int node = square_nodes_[index];
+  if (node == kNone) {
+    return;
+  }
+  Point step;
+  for (step.x = -1; step.x <= 1; step.x++) {
+    for (step.y = -1; step.y <= 1; step.y++) {
+      const Point neighbor = square + step;
+      const int region = GetRegion(neighbor);
+      if (region == kNone || region == regions_[index]) {
+        continue;
+      }
+      for (Edge& edge : nodes_[square_nodes_[Index(neighbor)]].edges) {
+        if (edge.node == node) {
+          edge.cost = GetStepCost(neighbor, square);
+        }
+      }
+    }
+  }
+}
+
+int HierarchicalPathfinder::GetStepCost(
+    const Point& from, const Point& to) const {
+  const Point step = to - from;
+  return engine::GetStepCost(
+      map_.GetTile(to), step.x != 0 && step.y != 0, costs_);
+}
+
+void HierarchicalPathfinder::Rebuild() {
+  regions_.assign(size_.x*size_.y, kNone);
+  square_nodes_.assign(size_.x*size_.y, kNone);
+  nodes_.clear();
+  region_nodes_.clear();
+  auto walkable = [this](const Point& square) {
+    return InBounds(square) && engine::GetStepCost(
+        map_.GetTile(square), false, costs_) != MoveCosts::kImpassable;
+  };
+
+  // Each room with a walkable square is a region, and so is each group of
+  // walkable squares outside the rooms within a block, which are flood-filled.
+  int num_regions = 0;
+  for (const TileMap::Room& room : map_.GetRooms()) {
+    bool used = false;
+    for (const Point& square : room.squares) {
+      if (walkable(square)) {
+        regions_[Index(square)] = num_regions;
+        used = true;
+      }
+    }
+    num_regions += used;
+  }
+  vector<Point> stack;
+  for (int i = 0; i < size_.x*size_.y; i++) {
+    if (regions_[i] != kNone || !walkable(GetSquare(i))) {
+      continue;
+    }
+    regions_[i] = num_regions;
+    stack.push_back(GetSquare(i));
+    while (!stack.empty()) {
+      const Point square = stack.back();
+      stack.pop_back();
+      Point step;
+      for (step.x = -1; step.x <= 1; step.x++) {
+        for (step.y = -1; step.y <= 1; step.y++) {
+          const Point neighbor = square + step;
+          if (walkable(neighbor) && InSameBlock(square, neighbor) &&
+              regions_[Index(neighbor)] == kNone) {
+            regions_[Index(neighbor)] = num_regions;
+            stack.push_back(neighbor);
+          }
+        }
+      }
+    }
+    num_regions += 1;
+  }
+  region_nodes_.resize(num_regions);
+
+  // Squares next to another region are nodes, with edges to the nodes next
+  // to them in other regions.
+  for (int i = 0; i < size_.x*size_.y; i++) {
+    const int region = regions_[i];
+    const Point square = GetSquare(i);
+    bool boundary = false;
+    Point step;
+    for (step.x = -1; step.x <= 1; step.x++) {
+      for (step.y = -1; step.y <= 1; step.y++) {
+        const int other = GetRegion(square + step);
+        boundary |= (region != kNone && other != kNone && other != region);
+      }
+    }
+    if (boundary) {
+      square_nodes_[i] = nodes_.size();
+      region_nodes_[region].push_back(nodes_.size());
+      nodes_.push_back(Node{square, region, {}});
+    }
+  }
+  for (Node& node : nodes_) {
+    Point step;
+    for (step.x = -1; step.x <= 1; step.x++) {
+      for (step.y = -1; step.y <= 1; step.y++) {
+        const Point neighbor = node.square + step;
+        const int other = GetRegion(neighbor);
+        if (other != kNone && other != node.region) {
+          node.edges.push_back(Edge{square_nodes_[Index(neighbor)],
+                                    GetStepCost(node.square, neighbor)});
+        }
+      }
+    }
+  }
+  for (int region = 0; region < num_regions; region++) {
+    ComputeRegionEdges(region);
+  }
+  node_labels_.assign(nodes_.size(), Label{0, 0, 0, 0});
+  node_generation_ = 0;
+}
+
+void HierarchicalPathfinder::ComputeRegionEdges(int region) {
+  for (int node : region_nodes_[region]) {
+    vector<Edge>& edges = nodes_[node].edges;
+    edges.erase(std::remove_if(edges.begin(), edges.end(),
+        [this, region](const Edge& edge) {
+          return nodes_[edge.node].region == region;
+        }), edges.end());
+    SearchRegion(nodes_[node].square, false /* reverse */);
+    for (int other : region_nodes_[region]) {
+      const Label& label = square_labels_[Index(nodes_[other].square)];
+      if (other != node && label.generation == square_generation_) {
+        edges.push_back(Edge{other, label.cost});
+      }
+    }
+  }
+}
+
+void HierarchicalPathfinder::SearchRegion(
+    const Point& from, bool reverse, int stop) {
+  const int region = GetRegion(from);
+  ASSERT(region != kNone);
+  NextGeneration(&square_labels_, &square_generation_);
+  heap_.clear();
+  Label& start = GetLabel(&square_labels_, square_generation_, Index(from));
+  start.cost = 0;
+  start.parent = kNone;
+  // Searches with a stop square are A* searches toward it.
+  const Point goal = (stop == kNone ? from : GetSquare(stop));
+  auto heuristic = [this, stop, &goal](const Point& square) {
+    return stop == kNone ? 0 : GetOctileDistance(square, goal, costs_);
+  };
+  Push(heuristic(from), Index(from));
+
+  while (!heap_.empty()) {
+    const HeapEntry entry = Pop();
+    const Point square = GetSquare(entry.second);
+    const int cost = square_labels_[entry.second].cost;
+    if (entry.first != cost + heuristic(square)) {
+      continue;
+    }
+    num_expanded_ += 1;
+    if (entry.second == stop) {
+      return;
+    }
+    Point step;
+    for (step.x = -1; step.x <= 1; step.x++) {
+      for (step.y = -1; step.y <= 1; step.y++) {
+        const Point neighbor = square + step;
+        if (step.zero() || GetRegion(neighbor) != region) {
+          continue;
+        }
+        const int child_cost = cost + (reverse ?
+            GetStepCost(neighbor, square) : GetStepCost(square, neighbor));
+        Label& label =
+            GetLabel(&square_labels_, square_generation_, Index(neighbor));
+        if (child_cost < label.cost) {
+          label.cost = child_cost;
+          label.parent = entry.second;
+          Push(child_cost + heuristic(neighbor), Index(neighbor));
+        }
+      }
+    }
+  }
+}
+
+void HierarchicalPathfinder::AppendRegionPath(
+    const Point& from, const Point& to, vector<Point>* path) {
+  if (from == to) {
+    return;
+  }
+  SearchRegion(from, false /* reverse */, Index(to));
+  ASSERT(square_labels_[Index(to)].generation == square_generation_);
+  const int start = path->size();
+  for (int i = Index(to); i != Index(from); i = square_labels_[i].parent) {
+    path->push_back(GetSquare(i));
+  }
+  std::reverse(path->begin() + start, path->end());
+}
+
+HierarchicalPathfinder::Label& HierarchicalPathfinder::GetLabel(
+    vector<Label>* labels, uint32_t generation, int index) {
+  Label& label = (*labels)[index];
+  if (label.generation != generation) {
+    label = Label{generation, INT_MAX, kNone, INT_MAX};
+  }
+  return label;
+}
+
+void HierarchicalPathfinder::NextGeneration(
+    vector<Label>* labels, uint32_t* generation) {
+  // Stamps wrap around after 2^32 searches. Labels stamped with the new
+  // generation would look current, so they are all reset first.
+  *generation += 1;
+  if (*generation == 0) {
+    for (Label& label : *labels) {
+      label.generation = 0;
+    }
+    *generation = 1;
+  }
+}
+
+void HierarchicalPathfinder::Push(int priority, int index) {
+  heap_.push_back(HeapEntry(priority, index));
+  std::push_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
+}
+
+HierarchicalPathfinder::HeapEntry HierarchicalPathfinder::Pop() {
+  std::pop_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
+  const HeapEntry entry = heap_.back();
+  heap_.pop_back();
+  return entry;
+}
+
+}  // namespace engine
+}  // namespace babel
@@ -0,0 +1,147 @@
+// HierarchicalPathfinder finds cheapest paths HPA*-style, by searching a
+// small abstract graph built on the map's rooms and refining the result with
+// local searches. Paths are exactly as cheap as Pathfinder's for the same
+// costs, but a path across a large level expands a few hundred squares and
+// nodes instead of most of the level.
+//
+// The map is split into regions: each of the map's rooms is a region, and so
+// is each connected group of walkable squares outside the rooms, which are
+// the corridors. (The corridors that level generation digs can cross and
+// merge, so the room pairs that it connected do not give the real graph.)
+// Corridor regions are also split at the edges of kBlockSize x kBlockSize
+// (16x16) blocks, so that a corridor network spanning the map does not make
+// searches within a region expensive.
+// The abstract graph's nodes are the squares next to a square in another
+// region: doorways and the room squares around them. Each node has an edge to
+// the nodes next to it in other regions, and an edge to each node in its own
+// region, weighted with the cost of the cheapest path within the region.
+//
+// A query searches the source's and the target's regions to connect them to
+// the graph, searches the graph, and then fills in each edge of the abstract
+// path with a search within its region.
+//
+// Opening or closing a door only changes edge weights, so it only recomputes
+// the edges within the door's region. Tile changes that make a square
+// walkable or not rebuild the whole graph.
+
+#ifndef __BABEL_ENGINE_HIERARCHICAL_PATHFINDER_H__
+#define __BABEL_ENGINE_HIERARCHICAL_PATHFINDER_H__
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "base/point.h"
+#include "engine/Pathfinder.h"
+#include "engine/TileMap.h"
+
+namespace babel {
+namespace engine {
+
+class HierarchicalPathfinder {
+ public:
+  // Does NOT take ownership of the map, which must outlive the pathfinder.
+  // Edge weights are computed with the given costs, which every query uses.
+  HierarchicalPathfinder(const TileMap& map, const MoveCosts& costs);
+
+  // Same contract as Pathfinder::FindPath.
+  bool FindPath(const Point& source, const Point& target,
+                std::vector<Point>* path);
+
+  // Must be called each time the tile at the given square changes.
+  void UpdateTile(const Point& square);
+
+  int GetNumRegions() const { return region_nodes_.size(); }
+  int GetNumNodes() const { return nodes_.size(); }
+
+  // The number of squares and nodes the last query expanded.
+  int GetNumExpanded() const { return num_expanded_; }
+
+ private:
+  static const int kNone = -1;
+
+  struct Edge {
+    int node;
+    int cost;
+  };
+
+  struct Node {
+    Point square;
+    int region;
+    std::vector<Edge> edges;
+  };
+
+  // Search state for a square or a node, stamped with the search's generation
+  // so that starting a search does not clear it. Nodes also keep the cost
+  // from them to the target, if they are in the target's region.
+  struct Label {
+    uint32_t generation;
+    int cost;
+    int parent;
+    int target_cost;
+  };
+
+  // Heap entries are (priority, index) pairs, with the lowest on top.
+  typedef std::pair<int,int> HeapEntry;
+
+  bool InBounds(const Point& square) const {
+    return (0 <= square.x && square.x < size_.x &&
+            0 <= square.y && square.y < size_.y);
+  }
+  // Squares are laid out like TileMap's tiles.
+  int Index(const Point& square) const { return square.x*size_.y + square.y; }
+  Point GetSquare(int index) const {
+    return Point(index/size_.y, index % size_.y);
+  }
+  int GetRegion(const Point& square) const {
+    return InBounds(square) ? regions_[Index(square)] : kNone;
+  }
+  int GetStepCost(const Point& from, const Point& to) const;
+
+  // Recomputes the regions, the nodes, and all of the edges.
+  void Rebuild();
+  // Recomputes the edges between the nodes in the region.
+  void ComputeRegionEdges(int region);
+
+  // Runs Dijkstra's algorithm from the square within its region. If a stop
+  // square is given, runs A* toward it instead, and stops once it is reached.
+  // Reverse searches compute the cost of paths to the square instead of from
+  // it.
+  void SearchRegion(const Point& from, bool reverse, int stop=kNone);
+  // Appends the squares along a cheapest path from one square to another in
+  // the same region to the path, not including the first square.
+  void AppendRegionPath(const Point& from, const Point& to,
+                        std::vector<Point>* path);
+
+  // Returns the label, resetting it if it was last touched by an older search.
+  static Label& GetLabel(std::vector<Label>* labels, uint32_t generation,
+                         int index);
+  static void NextGeneration(std::vector<Label>* labels,
+                             uint32_t* generation);
+  void Push(int priority, int index);
+  HeapEntry Pop();
+
+  const TileMap& map_;
+  const MoveCosts costs_;
+  const Point size_;
+
+  std::vector<int> regions_;
+  std::vector<int> square_nodes_;
+  std::vector<Node> nodes_;
+  std::vector<std::vector<int>> region_nodes_;
+
+  // Scratch space for searches. A query searches the graph between searches
+  // of regions, so squares and nodes are stamped with separate generations.
+  uint32_t square_generation_;
+  uint32_t node_generation_;
+  int num_expanded_;
+  std::vector<Label> square_labels_;
+  std::vector<Label> node_labels_;
+  std::vector<HeapEntry> heap_;
+  std::vector<int> abstract_path_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_HIERARCHICAL_PATHFINDER_H__
@@ -0,0 +1,171 @@
+#include "engine/Journal.h"
+
+#include "base/debug.h"
+
+using std::string;
+
+namespace babel {
+namespace engine {
+
+namespace {
+
+static const char kMagic[] = "BJNL";
+static const int kMagicSize = 4;
+static const uint64_t kVersion = 2;
+
+void WriteUnsigned(uint64_t value, string* bytes) {
+  while (value >= 0x80) {
+    bytes->push_back((char)(0x80 | (value & 0x7f)));
+    value >>= 7;
+  }
+  bytes->push_back((char)value);
+}
+
+void WriteSigned(int64_t value, string* bytes) {
+  WriteUnsigned(((uint64_t)value << 1) ^ (uint64_t)(value >> 63), bytes);
+}
+
+bool ReadUnsigned(const string& bytes, size_t* offset, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (*offset >= bytes.size()) {
+      return false;
+    }
+    const uint8_t byte = bytes[(*offset)++];
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReadSigned(const string& bytes, size_t* offset, int64_t* value) {
+  uint64_t zigzag;
+  if (!ReadUnsigned(bytes, offset, &zigzag)) {
+    return false;
+  }
+  *value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+  return true;
+}
+
+// Reads a value of type T, failing if it does not fit.
+template<typename T>
+bool ReadInt(const string& bytes, size_t* offset, T* value) {
+  int64_t result;
+  if (!ReadSigned(bytes, offset, &result) || (T)result != result) {
+    return false;
+  }
+  *value = (T)result;
+  return true;
+}
+
+template<typename T>
+bool ReadId(const string& bytes, size_t* offset, T* value) {
+  uint64_t result;
+  if (!ReadUnsigned(bytes, offset, &result) || (T)result != result) {
+    return false;
+  }
+  *value = (T)result;
+  return true;
+}
+
+}  // namespace
+
+Journal::Journal(uint32_t seed) : seed_(seed) {
+  bytes_.append(kMagic, kMagicSize);
+  WriteUnsigned(kVersion, &bytes_);
+  WriteUnsigned(seed, &bytes_);
+  header_size_ = bytes_.size();
+}
+
+bool Journal::Load(const string& bytes) {
+  size_t offset = kMagicSize;
+  uint64_t version;
+  uint32_t seed;
+  if (bytes.compare(0, kMagicSize, kMagic, kMagicSize) != 0 ||
+      !ReadUnsigned(bytes, &offset, &version) || version != kVersion ||
+      !ReadId(bytes, &offset, &seed)) {
+    return false;
+  }
+  seed_ = seed;
+  header_size_ = offset;
+  bytes_ = bytes;
+  return true;
+}
+
+void Journal::Append(long long turn, const Action& action) {
+  ASSERT(action.type != ActionType::NONE);
+  WriteUnsigned(turn, &bytes_);
+  bytes_.push_back((char)action.type);
+  switch (action.type) {
+    case ActionType::MOVE:
+    case ActionType::OPEN_DOOR:
+      WriteSigned(action.square.x, &bytes_);
+      WriteSigned(action.square.y, &bytes_);
+      break;
+    case ActionType::ATTACK:
+    case ActionType::LAUNCH_DIALOG:
+      WriteUnsigned(action.target, &bytes_);
+      break;
+    case ActionType::EXECUTE_COMBAT:
+      bytes_.push_back(action.combat.complete ? 1 : 0);
+      WriteSigned(action.combat.damage, &bytes_);
+      bytes_.push_back((char)action.combat.line);
+      WriteUnsigned(action.combat.source, &bytes_);
+      WriteUnsigned(action.combat.target, &bytes_);
+      break;
+    default:
+      ASSERT(false);
+  }
+}
+
+bool Journal::Read(size_t* offset, long long* turn, Action* action) const {
+  ASSERT(offset != nullptr && turn != nullptr && action != nullptr);
+  size_t cursor = *offset;
+  uint64_t turn_value;
+  if (!ReadUnsigned(bytes_, &cursor, &turn_value) ||
+      cursor >= bytes_.size()) {
+    return false;
+  }
+  Action result;
+  result.type = (ActionType)bytes_[cursor++];
+  bool valid = false;
+  switch (result.type) {
+    case ActionType::MOVE:
+    case ActionType::OPEN_DOOR:
+      valid = (ReadInt(bytes_, &cursor, &result.square.x) &&
+               ReadInt(bytes_, &cursor, &result.square.y));
+      break;
+    case ActionType::ATTACK:
+    case ActionType::LAUNCH_DIALOG:
+      valid = ReadId(bytes_, &cursor, &result.target);
+      break;
+    case ActionType::EXECUTE_COMBAT: {
+      Action::CombatArgs& args = result.combat;
+      valid = (cursor < bytes_.size() && (uint8_t)bytes_[cursor] <= 1);
+      args.complete = valid && bytes_[cursor++] == 1;
+      valid = (valid && ReadInt(bytes_, &cursor, &args.damage) &&
+               cursor < bytes_.size() &&
+               (uint8_t)bytes_[cursor] <= CombatLine::ENEMY_HITS);
+      if (valid) {
+        args.line = (CombatLine)bytes_[cursor++];
+        valid = (ReadId(bytes_, &cursor, &args.source) &&
+                 ReadId(bytes_, &cursor, &args.target));
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  if (!valid) {
+    return false;
+  }
+  *offset = cursor;
+  *turn = turn_value;
+  *action = result;
+  return true;
+}
+
+}  // namespace engine
+}  // namespace babel
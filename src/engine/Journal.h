@@ -0,0 +1,53 @@
+// Journal is a compact binary record of the inputs that an Engine consumed.
+// Since all of the game's randomness comes from the seeded RNG in its game
+// state, the seed and the sequence of inputs determine the whole game, and
+// replaying a journal (with Engine::Replay) rebuilds the exact game state.
+//
+// The format is a header - a magic number, a version, and the seed - followed
+// by one record per input. A record is the number of turns that had been taken
+// when the input was consumed, the action's type as one byte, and the type's
+// arguments. All integers are varints, and signed ones are zigzag-encoded, so
+// a typical move takes three bytes.
+
+#ifndef __BABEL_ENGINE_JOURNAL_H__
+#define __BABEL_ENGINE_JOURNAL_H__
+
+#include <stdint.h>
+#include <string>
+
+#include "engine/Action.h"
+
+namespace babel {
+namespace engine {
+
+class Journal {
+ public:
+  // Starts an empty journal for a game with the given seed.
+  Journal(uint32_t seed);
+
+  // Loads a serialized journal. Returns false, and leaves the journal
+  // unchanged, if the bytes do not start with a valid header. Corrupt records
+  // are detected when they are read.
+  bool Load(const std::string& bytes);
+
+  void Append(long long turn, const Action& action);
+
+  // Reads the record at the given offset into turn and action, and advances
+  // the offset past it. Returns false at the end of the journal or if the
+  // record is corrupt. Start reading at GetStartOffset.
+  bool Read(size_t* offset, long long* turn, Action* action) const;
+
+  size_t GetStartOffset() const { return header_size_; }
+  uint32_t GetSeed() const { return seed_; }
+  const std::string& GetBytes() const { return bytes_; }
+
+ private:
+  uint32_t seed_;
+  size_t header_size_;
+  std::string bytes_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_JOURNAL_H__
@@ -0,0 +1,146 @@
+#include "engine/JumpPointTable.h"
+
+#include "base/debug.h"
+
+using std::vector;
+
+namespace babel {
+namespace engine {
+
+const int JumpPointTable::kNumDirections;
+const Point JumpPointTable::kDirections[kNumDirections] = {
+    Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1),
+    Point(1, 1), Point(-1, 1), Point(-1, -1), Point(1, -1)};
+
+namespace {
+
+static const int kNumStraightDirections = 4;
+
+// Distances must fit in an int16_t.
+static const int kMaxSize = 1 << 15;
+
+}  // namespace
+
+int JumpPointTable::GetDirection(const Point& step) {
+  // Indexed by (step.y + 1)*3 + (step.x + 1).
+  static const int kIndices[9] = {6, 3, 7, 1, -1, 0, 5, 2, 4};
+  ASSERT(-1 <= step.x && step.x <= 1 && -1 <= step.y && step.y <= 1);
+  return kIndices[3*(step.y + 1) + step.x + 1];
+}
+
+JumpPointTable::JumpPointTable(const BitGrid& walls)
+    : walls_(walls), distances_(kNumDirections*walls.GetSize().x*
+                                walls.GetSize().y) {
+  const Point& size = walls_.GetSize();
+  ASSERT(size.x < kMaxSize && size.y < kMaxSize);
+  // Each distance depends on the next square's, so squares are visited from
+  // the far end of each direction. Diagonal scans stop at squares where
+  // straight scans find jump points, so straight directions go first.
+  for (int direction = 0; direction < kNumDirections; direction++) {
+    const Point& step = kDirections[direction];
+    for (int i = 0; i < size.x; i++) {
+      const int x = (step.x > 0 ? size.x - 1 - i : i);
+      for (int j = 0; j < size.y; j++) {
+        const int y = (step.y > 0 ? size.y - 1 - j : j);
+        Distance(Point(x, y), direction) =
+            ComputeDistance(Point(x, y), direction);
+      }
+    }
+  }
+}
+
+void JumpPointTable::UpdateTile(const Point& square, bool blocked) {
+  if (!walls_.InBounds(square) || walls_.Get(square) == blocked) {
+    return;
+  } else if (blocked) {
+    walls_.Set(square);
+  } else {
+    walls_.Reset(square);
+  }
+  // Whether a square is a jump point depends on the squares around it, so a
+  // tile change can affect the jump points around it, and the distances of
+  // the squares that step onto them.
+  vector<Point> sign_changes;
+  pending_.clear();
+  for (int direction = 0; direction < kNumDirections; direction++) {
+    if (direction == kNumStraightDirections) {
+      // Diagonal scans also stop where straight distances became positive.
+      Propagate(&sign_changes);
+      for (const Point& changed : sign_changes) {
+        for (int i = kNumStraightDirections; i < kNumDirections; i++) {
+          pending_.push_back(std::make_pair(changed - kDirections[i], i));
+        }
+      }
+    }
+    Point offset;
+    for (offset.x = -1; offset.x <= 1; offset.x++) {
+      for (offset.y = -1; offset.y <= 1; offset.y++) {
+        pending_.push_back(std::make_pair(
+            square + offset - kDirections[direction], direction));
+      }
+    }
+  }
+  Propagate(nullptr);
+}
+
+int JumpPointTable::GetMemoryUsage() const {
+  return (sizeof(int16_t)*distances_.size() +
+          sizeof(uint64_t)*walls_.GetWordsPerRow()*walls_.GetSize().y);
+}
+
+bool JumpPointTable::IsJumpPoint(const Point& square, int direction) const {
+  const Point& step = kDirections[direction];
+  if (direction < kNumStraightDirections) {
+    // A neighbor beside the next square is forced if the square beside this
+    // one is a wall.
+    const Point side(step.y, step.x);
+    return (!IsSquareFree(square + side) &&
+            IsSquareFree(square + side + step)) ||
+           (!IsSquareFree(square - side) &&
+            IsSquareFree(square - side + step));
+  }
+  const Point step_x(step.x, 0);
+  const Point step_y(0, step.y);
+  return (!IsSquareFree(square - step_x) &&
+          IsSquareFree(square - step_x + step_y)) ||
+         (!IsSquareFree(square - step_y) &&
+          IsSquareFree(square - step_y + step_x)) ||
+         GetDistance(square, GetDirection(step_x)) > 0 ||
+         GetDistance(square, GetDirection(step_y)) > 0;
+}
+
+int JumpPointTable::ComputeDistance(const Point& square, int direction) const {
+  const Point next = square + kDirections[direction];
+  if (!IsSquareFree(square) || !IsSquareFree(next)) {
+    return 0;
+  } else if (IsJumpPoint(next, direction)) {
+    return 1;
+  }
+  const int distance = GetDistance(next, direction);
+  return distance > 0 ? distance + 1 : distance - 1;
+}
+
+void JumpPointTable::Propagate(vector<Point>* sign_changes) {
+  while (!pending_.empty()) {
+    const Point square = pending_.back().first;
+    const int direction = pending_.back().second;
+    pending_.pop_back();
+    if (!walls_.InBounds(square)) {
+      continue;
+    }
+    const int distance = ComputeDistance(square, direction);
+    int16_t& entry = Distance(square, direction);
+    if (distance == entry) {
+      continue;
+    }
+    if (sign_changes != nullptr && (distance > 0) != (entry > 0)) {
+      sign_changes->push_back(square);
+    }
+    entry = distance;
+    pending_.push_back(std::make_pair(square - kDirections[direction],
+                                      direction));
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
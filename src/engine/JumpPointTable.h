@@ -0,0 +1,87 @@
+// JumpPointTable holds the precomputed jump distances for JPS+, a variant of
+// Jump Point Search, on the 8-connected grid of free squares. Diagonal steps
+// may cut corners, as they may in the game, so only the destination square
+// of a step has to be free.
+//
+// Jump Point Search prunes the symmetric paths that make A* expand most of an
+// open region: a search moving in one direction skips ahead to the next jump
+// point, a square where some neighbor can only be reached optimally through
+// it. For each free square and each of the 8 directions, the table stores how
+// far the search jumps from that square: a positive distance to the next jump
+// point, or zero or a negative distance to the last free square before a wall.
+// Straight scans stop at squares with forced neighbors. Diagonal scans also
+// stop at squares from which a straight scan along either component of the
+// direction reaches a jump point.
+//
+// Each distance depends only on the squares around the next square in its
+// direction and on that square's own distances, so a tile change only updates
+// the rays that lead into the squares around it, and stops walking back along
+// a ray as soon as a distance comes out unchanged.
+
+#ifndef __BABEL_ENGINE_JUMP_POINT_TABLE_H__
+#define __BABEL_ENGINE_JUMP_POINT_TABLE_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/bit_grid.h"
+#include "base/point.h"
+
+namespace babel {
+namespace engine {
+
+class JumpPointTable {
+ public:
+  // The straight directions come first, then the diagonal ones.
+  static const int kNumDirections = 8;
+  static const Point kDirections[kNumDirections];
+
+  // Returns the index of a step in kDirections, or -1 for a zero step.
+  static int GetDirection(const Point& step);
+
+  // walls has a set bit for each square that is not free.
+  JumpPointTable(const BitGrid& walls);
+
+  bool IsSquareFree(const Point& square) const {
+    return walls_.InBounds(square) && !walls_.Get(square);
+  }
+
+  // Returns the jump distance from a free square in the given direction.
+  int GetDistance(const Point& square, int direction) const {
+    return distances_[kNumDirections*Index(square) + direction];
+  }
+
+  // Must be called each time the square becomes free or stops being free.
+  void UpdateTile(const Point& square, bool blocked);
+
+  int GetMemoryUsage() const;
+
+ private:
+  int Index(const Point& square) const {
+    return square.x*walls_.GetSize().y + square.y;
+  }
+  int16_t& Distance(const Point& square, int direction) {
+    return distances_[kNumDirections*Index(square) + direction];
+  }
+
+  // Returns true if a scan in the given direction stops at the free square.
+  bool IsJumpPoint(const Point& square, int direction) const;
+
+  // Computes the square's distance from the next square in the direction.
+  int ComputeDistance(const Point& square, int direction) const;
+
+  // Recomputes the distances queued in pending_, and walks back along each
+  // ray until a distance is unchanged. If sign_changes is not null, adds each
+  // square whose distance became or stopped being positive to it.
+  void Propagate(std::vector<Point>* sign_changes);
+
+  BitGrid walls_;
+  std::vector<int16_t> distances_;
+  // Scratch space for UpdateTile, as pairs of (square, direction).
+  std::vector<std::pair<Point,int>> pending_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_JUMP_POINT_TABLE_H__
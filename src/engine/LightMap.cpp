@@ -0,0 +1,100 @@
+#include "engine/LightMap.h"
+
+#include <cstdlib>
+
+#include "base/debug.h"
+
+namespace babel {
+namespace engine {
+
+LightMap::LightMap(const BitGrid& opacity)
+    : opacity_(opacity), size_(opacity.GetSize()), ambient_(0),
+      levels_(size_.x*size_.y, 0) {}
+
+LightId LightMap::AddLight(const Point& source, int radius) {
+  ASSERT(radius >= 0);
+  LightId id = lights_.size();
+  if (free_ids_.empty()) {
+    lights_.emplace_back();
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  }
+  Light& light = lights_[id];
+  light.radius = radius;
+  light.vision.reset(new FieldOfVision(opacity_, source, radius));
+  AddBrightness(light, 1);
+  return id;
+}
+
+void LightMap::MoveLight(LightId id, const Point& source) {
+  ASSERT(0 <= id && id < (int)lights_.size());
+  Light& light = lights_[id];
+  ASSERT(light.vision != nullptr);
+  AddBrightness(light, -1);
+  light.vision.reset(new FieldOfVision(opacity_, source, light.radius));
+  AddBrightness(light, 1);
+}
+
+void LightMap::RemoveLight(LightId id) {
+  ASSERT(0 <= id && id < (int)lights_.size());
+  Light& light = lights_[id];
+  ASSERT(light.vision != nullptr);
+  AddBrightness(light, -1);
+  light.vision.reset();
+  free_ids_.push_back(id);
+}
+
+void LightMap::UpdateTile(const Point& square, bool was_blocked) {
+  for (Light& light : lights_) {
+    if (light.vision == nullptr) {
+      continue;
+    }
+    const Point diff = square - light.vision->GetOffset();
+    if (diff.x < 0 || diff.x > 2*light.radius ||
+        diff.y < 0 || diff.y > 2*light.radius) {
+      continue;
+    }
+    // Assigning to the scratch grid reuses its words once it has grown to
+    // the largest light, so this does not allocate.
+    before_ = light.vision->GetVisibleSquares();
+    if (!light.vision->UpdateSquare(square, was_blocked)) {
+      continue;
+    }
+    // Only squares whose visibility changed need their levels updated.
+    const BitGrid& after = light.vision->GetVisibleSquares();
+    for (int y = 0; y < after.GetSize().y; y++) {
+      for (int i = 0; i < after.GetWordsPerRow(); i++) {
+        const uint64_t changed = before_.Row(y)[i] ^ after.Row(y)[i];
+        AddBrightness(light, y, i, changed & before_.Row(y)[i], -1);
+        AddBrightness(light, y, i, changed & after.Row(y)[i], 1);
+      }
+    }
+  }
+}
+
+void LightMap::AddBrightness(const Light& light, int sign) {
+  const BitGrid& squares = light.vision->GetVisibleSquares();
+  for (int y = 0; y < squares.GetSize().y; y++) {
+    for (int i = 0; i < squares.GetWordsPerRow(); i++) {
+      AddBrightness(light, y, i, squares.Row(y)[i], sign);
+    }
+  }
+}
+
+void LightMap::AddBrightness(
+    const Light& light, int y, int i, uint64_t word, int sign) {
+  const Point& offset = light.vision->GetOffset();
+  const int radius = light.radius;
+  for (; word != 0; word &= word - 1) {
+    const Point diff(64*i + __builtin_ctzll(word) - radius, y - radius);
+    const Point square = offset + diff + Point(radius, radius);
+    if (InBounds(square)) {
+      const int brightness = radius*radius - diff.x*diff.x - diff.y*diff.y;
+      levels_[Index(square)] += sign*brightness;
+    }
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
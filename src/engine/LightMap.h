@@ -0,0 +1,88 @@
+// LightMap is an illumination layer over the map. It stores a light level for
+// every square: the ambient level, plus the brightness of each light source
+// that reaches the square. A light reaches the squares in its own field of
+// vision, and its brightness at a square is radius^2 - distance^2, so it
+// fades to nothing at the rim.
+//
+// Levels are maintained incrementally. Each light keeps its field of vision,
+// and its contribution is added to the level grid once. Moving a light
+// recomputes only that light: its old contribution is subtracted and its new
+// one added, since a move changes its brightness at every square it reaches.
+// A tile change only updates the lights whose radius covers the changed
+// square, and only touches the squares whose visibility changed.
+//
+// The opacity grid is shared with the owner, which must keep it in sync with
+// the map and must call UpdateTile after changing it.
+
+#ifndef __BABEL_ENGINE_LIGHT_MAP_H__
+#define __BABEL_ENGINE_LIGHT_MAP_H__
+
+#include <memory>
+#include <vector>
+
+#include "base/bit_grid.h"
+#include "base/point.h"
+#include "engine/FieldOfVision.h"
+
+namespace babel {
+namespace engine {
+
+typedef int LightId;
+static const LightId kInvalidLight = -1;
+
+class LightMap {
+ public:
+  // Does NOT take ownership of the opacity grid, which must outlive this map.
+  // The map starts out dark, with no lights.
+  LightMap(const BitGrid& opacity);
+
+  // Light ids are reused after a light is removed.
+  LightId AddLight(const Point& source, int radius);
+  void MoveLight(LightId id, const Point& source);
+  void RemoveLight(LightId id);
+
+  // Must be called each time the tile at the given square changes.
+  void UpdateTile(const Point& square, bool was_blocked);
+
+  // The ambient level is added to every square, on the map or not.
+  void SetAmbientLight(int level) { ambient_ = level; }
+
+  int GetLight(const Point& square) const {
+    return ambient_ + (InBounds(square) ? levels_[Index(square)] : 0);
+  }
+  bool IsSquareLit(const Point& square) const { return GetLight(square) > 0; }
+
+ private:
+  struct Light {
+    int radius;
+    std::unique_ptr<FieldOfVision> vision;
+  };
+
+  bool InBounds(const Point& square) const {
+    return (0 <= square.x && square.x < size_.x &&
+            0 <= square.y && square.y < size_.y);
+  }
+  // Levels are laid out like TileMap's tiles.
+  int Index(const Point& square) const { return square.x*size_.y + square.y; }
+
+  // Adds sign times the light's brightness to each square that it reaches.
+  void AddBrightness(const Light& light, int sign);
+  // Does the same for the squares whose bits are set in the word, which is
+  // word i of row y of the light's field of vision.
+  void AddBrightness(const Light& light, int y, int i, uint64_t word, int sign);
+
+  const BitGrid& opacity_;
+  const Point size_;
+  int ambient_;
+  std::vector<int> levels_;
+  std::vector<Light> lights_;
+  std::vector<LightId> free_ids_;
+  // Scratch space for UpdateTile: a light's field of vision from before the
+  // tile changed.
+  BitGrid before_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_LIGHT_MAP_H__
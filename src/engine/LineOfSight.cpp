@@ -0,0 +1,106 @@
+#include "engine/LineOfSight.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+
+#include "base/debug.h"
+#include "engine/PermissiveFov.h"
+
+namespace babel {
+namespace engine {
+
+namespace {
+
+// Scans for a single target square, with everything outside the box between
+// the source and the target blocked.
+class TargetSearch {
+ public:
+  TargetSearch(const BitGrid& opacity, const Point& min, const Point& max,
+               const Point& target)
+      : opacity_(opacity), min_(min), max_(max), target_(target),
+        found_(false) {}
+
+  bool IsBlocked(const Point& square) const {
+    return (square.x < min_.x || square.x > max_.x ||
+            square.y < min_.y || square.y > max_.y || opacity_.Get(square));
+  }
+
+  void Visit(const Point& square) {
+    found_ |= square == target_;
+  }
+
+  bool Found() const { return found_; }
+
+ private:
+  const BitGrid& opacity_;
+  const Point min_;
+  const Point max_;
+  const Point target_;
+  bool found_;
+};
+
+// The coordinates are multiplied as unsigned values, which wrap around
+// instead of overflowing.
+int GetCacheIndex(const Point& a, const Point& b, int cache_size) {
+  const uint32_t hash = ((uint32_t)a.x*73856093u) ^ ((uint32_t)a.y*19349663u) ^
+                        ((uint32_t)b.x*83492791u) ^ ((uint32_t)b.y*50331653u);
+  return (hash ^ (hash >> 16)) % cache_size;
+}
+
+}  // namespace
+
+LineOfSight::LineOfSight(const BitGrid& opacity, int cache_size)
+    : opacity_(opacity), cache_(cache_size) {
+  ASSERT(cache_size > 0);
+}
+
+bool LineOfSight::IsVisible(const Point& a, const Point& b) {
+  if (!opacity_.InBounds(a) || !opacity_.InBounds(b)) {
+    return false;
+  }
+  // Order the pair so that both directions share a cache entry.
+  const bool swap = b.x < a.x || (b.x == a.x && b.y < a.y);
+  const Point& first = (swap ? b : a);
+  const Point& second = (swap ? a : b);
+  Entry& entry = cache_[GetCacheIndex(first, second, cache_.size())];
+  if (!entry.valid || entry.a != first || entry.b != second) {
+    entry.min = Point(std::min(a.x, b.x), std::min(a.y, b.y));
+    entry.max = Point(std::max(a.x, b.x), std::max(a.y, b.y));
+    entry.a = first;
+    entry.b = second;
+    entry.valid = true;
+    entry.visible = Compute(entry);
+  }
+  return entry.visible;
+}
+
+void LineOfSight::UpdateTile(const Point& square) {
+  for (Entry& entry : cache_) {
+    if (entry.min.x <= square.x && square.x <= entry.max.x &&
+        entry.min.y <= square.y && square.y <= entry.max.y) {
+      entry.valid = false;
+    }
+  }
+}
+
+bool LineOfSight::Compute(const Entry& entry) const {
+  const Point diff = entry.b - entry.a;
+  if (diff.x == 0 && diff.y == 0) {
+    return true;
+  }
+  // Use the quadrant that visits the target if it is on one of the axes.
+  Point quadrant(diff.x < 0 ? -1 : 1, diff.y < 0 ? -1 : 1);
+  if (diff.x == 0) {
+    quadrant.x = -quadrant.y;
+  } else if (diff.y == 0) {
+    quadrant.y = quadrant.x;
+  }
+  TargetSearch search(opacity_, entry.min, entry.max, entry.b);
+  const int radius = std::max(abs(diff.x), abs(diff.y));
+  gPermissiveFov.ComputeQuadrant(entry.a, quadrant, radius, &search);
+  return search.Found();
+}
+
+}  // namespace engine
+}  // namespace babel
@@ -0,0 +1,56 @@
+// LineOfSight answers "can a see b" for pairs of squares on the map, without
+// computing a whole field of vision for either one. Answers agree with
+// FieldOfVision: b is visible from a if it would be visible in a's field of
+// vision with a radius large enough to contain it. Permissive field-of-view
+// is symmetric, so the answer is the same in both directions.
+//
+// A query scans a single quadrant, and treats every square outside the
+// bounding box of a and b as blocked, since no line between the two squares
+// passes through them. The scan reuses per-thread scratch space and does not
+// allocate. Answers are kept in a small direct-mapped cache, and a tile
+// change only evicts the answers whose bounding box contains the tile.
+
+#ifndef __BABEL_ENGINE_LINE_OF_SIGHT_H__
+#define __BABEL_ENGINE_LINE_OF_SIGHT_H__
+
+#include <vector>
+
+#include "base/bit_grid.h"
+#include "base/point.h"
+
+namespace babel {
+namespace engine {
+
+class LineOfSight {
+ public:
+  // Does NOT take ownership of the opacity grid, which must outlive this
+  // object. Its owner must call UpdateTile after changing it.
+  LineOfSight(const BitGrid& opacity, int cache_size);
+
+  // Returns true if each square is visible from the other. Squares off the
+  // map are never visible.
+  bool IsVisible(const Point& a, const Point& b);
+
+  void UpdateTile(const Point& square);
+
+ private:
+  struct Entry {
+    Point min;
+    Point max;
+    Point a;
+    Point b;
+    bool valid;
+    bool visible;
+  };
+
+  // Scans from the entry's a toward its b.
+  bool Compute(const Entry& entry) const;
+
+  const BitGrid& opacity_;
+  std::vector<Entry> cache_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_LINE_OF_SIGHT_H__
@@ -0,0 +1,56 @@
+#include "engine/OccupancyGrid.h"
+
+#include "base/debug.h"
+
+namespace babel {
+namespace engine {
+
+OccupancyGrid::OccupancyGrid(const TileMap& map)
+    : map_(map), size_(map.GetSize()), sprites_(size_.x*size_.y, kInvalidSid),
+      bits_((size_.x*size_.y + 63)/64, 0) {
+  for (int x = 0; x < size_.x; x++) {
+    for (int y = 0; y < size_.y; y++) {
+      const Point square(x, y);
+      UpdateBit(Index(square), square);
+    }
+  }
+}
+
+void OccupancyGrid::AddSprite(const Point& square, sid id) {
+  ASSERT(id != kInvalidSid);
+  ASSERT(SpriteAt(square) == kInvalidSid && InBounds(square));
+  const int index = Index(square);
+  sprites_[index] = id;
+  UpdateBit(index, square);
+}
+
+void OccupancyGrid::RemoveSprite(const Point& square) {
+  ASSERT(SpriteAt(square) != kInvalidSid);
+  const int index = Index(square);
+  sprites_[index] = kInvalidSid;
+  UpdateBit(index, square);
+}
+
+void OccupancyGrid::MoveSprite(const Point& from, const Point& to) {
+  const sid id = SpriteAt(from);
+  RemoveSprite(from);
+  AddSprite(to, id);
+}
+
+void OccupancyGrid::UpdateTile(const Point& square) {
+  if (InBounds(square)) {
+    UpdateBit(Index(square), square);
+  }
+}
+
+void OccupancyGrid::UpdateBit(int index, const Point& square) {
+  const uint64_t mask = 1ULL << (index & 63);
+  if (sprites_[index] != kInvalidSid || map_.IsSquareBlocked(square)) {
+    bits_[index >> 6] |= mask;
+  } else {
+    bits_[index >> 6] &= ~mask;
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
@@ -0,0 +1,68 @@
+// OccupancyGrid is a dense index of sprite positions, stored as flat arrays
+// laid out like TileMap's tiles. Each square holds the id of the sprite on it,
+// so lookups are a single array load and updates are O(1).
+//
+// It also keeps a bitplane with one bit per square that is set if the square
+// is blocked or occupied, which is the check that movement code needs. The
+// owner must call UpdateTile whenever the map's tile at a square changes.
+
+#ifndef __BABEL_ENGINE_OCCUPANCY_GRID_H__
+#define __BABEL_ENGINE_OCCUPANCY_GRID_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/point.h"
+#include "engine/Sprite.h"
+#include "engine/TileMap.h"
+
+namespace babel {
+namespace engine {
+
+class OccupancyGrid {
+ public:
+  // Does NOT take ownership of the map, which must outlive the grid.
+  OccupancyGrid(const TileMap& map);
+
+  // Sprites must be placed on free, in-bounds squares.
+  void AddSprite(const Point& square, sid id);
+  void RemoveSprite(const Point& square);
+  void MoveSprite(const Point& from, const Point& to);
+  void UpdateTile(const Point& square);
+
+  // Returns kInvalidSid if the square is free or out of bounds.
+  sid SpriteAt(const Point& square) const {
+    return InBounds(square) ? sprites_[Index(square)] : kInvalidSid;
+  }
+
+  // Out-of-bounds squares are blocked.
+  bool IsSquareBlockedOrOccupied(const Point& square) const {
+    if (!InBounds(square)) {
+      return true;
+    }
+    const int index = Index(square);
+    return (bits_[index >> 6] >> (index & 63)) & 1;
+  }
+
+ private:
+  bool InBounds(const Point& square) const {
+    return (0 <= square.x && square.x < size_.x &&
+            0 <= square.y && square.y < size_.y);
+  }
+
+  int Index(const Point& square) const {
+    return square.x*size_.y + square.y;
+  }
+
+  void UpdateBit(int index, const Point& square);
+
+  const TileMap& map_;
+  const Point size_;
+  std::vector<sid> sprites_;
+  std::vector<uint64_t> bits_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_OCCUPANCY_GRID_H__
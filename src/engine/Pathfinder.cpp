@@ -0,0 +1,324 @@
+#include "engine/Pathfinder.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#include "base/debug.h"
+
+using std::max;
+using std::min;
+using std::vector;
+
+namespace babel {
+namespace engine {
+
+namespace {
+
+// Returns the step along a straight or diagonal line with the given offset.
+Point GetStep(const Point& diff) {
+  return Point((diff.x > 0) - (diff.x < 0), (diff.y > 0) - (diff.y < 0));
+}
+
+}  // namespace
+
+const int MoveCosts::kImpassable;
+const int Pathfinder::kUnvisited;
+const int Pathfinder::kClosed;
+
+int GetStepCost(Tile tile, bool diagonal, const MoveCosts& costs) {
+  int extra = 0;
+  switch (tile) {
+    case Tile::FREE:
+      break;
+    case Tile::DOOR:
+      extra = costs.door;
+      break;
+    case Tile::FENCE:
+      extra = costs.fence;
+      break;
+    default:
+      return MoveCosts::kImpassable;
+  }
+  if (extra == MoveCosts::kImpassable) {
+    return MoveCosts::kImpassable;
+  }
+  return (diagonal ? costs.diagonal : costs.orthogonal) + extra;
+}
+
+int GetOctileDistance(const Point& a, const Point& b, const MoveCosts& costs) {
+  const int dx = abs(b.x - a.x);
+  const int dy = abs(b.y - a.y);
+  return (costs.diagonal*min(dx, dy) +
+          costs.orthogonal*(max(dx, dy) - min(dx, dy)));
+}
+
+Pathfinder::Pathfinder(const TileMap& map)
+    : map_(map), size_(map.GetSize()), generation_(0), num_expanded_(0),
+      nodes_(size_.x*size_.y, Node{0, 0, 0, kUnvisited}) {}
+
+bool Pathfinder::FindPath(const Point& source, const Point& target,
+                          const MoveCosts& costs, vector<Point>* path) {
+  ASSERT(path != nullptr);
+  ASSERT(costs.orthogonal > 0 && costs.orthogonal <= costs.diagonal &&
+         costs.diagonal <= 2*costs.orthogonal);
+  path->clear();
+  num_expanded_ = 0;
+  if (!InBounds(source) || !InBounds(target)) {
+    return false;
+  } else if (source == target) {
+    return true;
+  }
+
+  StartSearch(source, target, costs);
+  const int target_index = Index(target);
+  while (!heap_.empty()) {
+    const int index = Pop().index;
+    if (index == target_index) {
+      GetPath(Index(source), target_index, path);
+      return true;
+    }
+    num_expanded_ += 1;
+    const Point square(index/size_.y, index % size_.y);
+    const int cost = nodes_[index].cost;
+    Point step;
+    for (step.x = -1; step.x <= 1; step.x++) {
+      for (step.y = -1; step.y <= 1; step.y++) {
+        const Point child = square + step;
+        if (step.zero() || !InBounds(child)) {
+          continue;
+        }
+        const int step_cost = GetStepCost(
+            map_.GetTile(child), step.x != 0 && step.y != 0, costs);
+        if (step_cost != MoveCosts::kImpassable) {
+          Relax(child, index, cost + step_cost, target, costs);
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool Pathfinder::FindJumpPointPath(const Point& source, const Point& target,
+                                   const MoveCosts& costs,
+                                   vector<Point>* path) {
+  ASSERT(path != nullptr);
+  ASSERT(costs.orthogonal > 0 && costs.orthogonal < costs.diagonal &&
+         costs.diagonal < 2*costs.orthogonal);
+  const JumpPointTable& table = map_.GetJumpPointTable();
+  path->clear();
+  num_expanded_ = 0;
+  if (!InBounds(source) || !table.IsSquareFree(target)) {
+    return false;
+  } else if (source == target) {
+    return true;
+  }
+
+  StartSearch(source, target, costs);
+  const int source_index = Index(source);
+  const int target_index = Index(target);
+  while (!heap_.empty()) {
+    const int index = Pop().index;
+    if (index == target_index) {
+      GetPath(source_index, target_index, path);
+      return true;
+    }
+    num_expanded_ += 1;
+    const Point square(index/size_.y, index % size_.y);
+    const int cost = nodes_[index].cost;
+
+    // Each direction's bit is set if the search continues in it. The source
+    // continues in every direction. Other squares continue in the directions
+    // of their natural neighbors, which are those that can only be reached
+    // optimally through the square, and of their forced neighbors, which are
+    // those that a wall beside the square makes so.
+    int directions = (1 << JumpPointTable::kNumDirections) - 1;
+    if (index != source_index) {
+      const int parent = nodes_[index].parent;
+      const Point step =
+          GetStep(square - Point(parent/size_.y, parent % size_.y));
+      directions = 1 << JumpPointTable::GetDirection(step);
+      if (step.x == 0 || step.y == 0) {
+        const Point side(step.y, step.x);
+        if (!table.IsSquareFree(square + side)) {
+          directions |= 1 << JumpPointTable::GetDirection(step + side);
+        }
+        if (!table.IsSquareFree(square - side)) {
+          directions |= 1 << JumpPointTable::GetDirection(step - side);
+        }
+      } else {
+        const Point step_x(step.x, 0);
+        const Point step_y(0, step.y);
+        directions |= 1 << JumpPointTable::GetDirection(step_x);
+        directions |= 1 << JumpPointTable::GetDirection(step_y);
+        if (!table.IsSquareFree(square - step_x)) {
+          directions |= 1 << JumpPointTable::GetDirection(step_y - step_x);
+        }
+        if (!table.IsSquareFree(square - step_y)) {
+          directions |= 1 << JumpPointTable::GetDirection(step_x - step_y);
+        }
+      }
+    }
+
+    for (int i = 0; i < JumpPointTable::kNumDirections; i++) {
+      if (!((directions >> i) & 1)) {
+        continue;
+      }
+      const int steps = Jump(table, square, i, target);
+      if (steps == 0) {
+        continue;
+      }
+      const Point& step = JumpPointTable::kDirections[i];
+      const int step_cost = (step.x != 0 && step.y != 0 ?
+                             costs.diagonal : costs.orthogonal);
+      Relax(square + step*steps, index, cost + steps*step_cost, target, costs);
+    }
+  }
+  return false;
+}
+
+void Pathfinder::StartSearch(const Point& source, const Point& target,
+                             const MoveCosts& costs) {
+  // Stamps wrap around after 2^32 queries. Nodes stamped with the new
+  // generation would look current, so they are all reset first.
+  generation_ += 1;
+  if (generation_ == 0) {
+    for (Node& node : nodes_) {
+      node.generation = 0;
+    }
+    generation_ = 1;
+  }
+  heap_.clear();
+
+  const int index = Index(source);
+  Node& node = GetNode(index);
+  node.cost = 0;
+  node.parent = index;
+  const int heuristic = GetOctileDistance(source, target, costs);
+  Push(HeapEntry{heuristic, heuristic, index});
+}
+
+void Pathfinder::GetPath(int source_index, int target_index,
+                         vector<Point>* path) {
+  for (int i = target_index; i != source_index; i = nodes_[i].parent) {
+    const Point square(i/size_.y, i % size_.y);
+    const int parent = nodes_[i].parent;
+    const Point diff = Point(parent/size_.y, parent % size_.y) - square;
+    const Point step = GetStep(diff);
+    for (Point skipped = square; skipped != square + diff; skipped += step) {
+      path->push_back(skipped);
+    }
+  }
+  std::reverse(path->begin(), path->end());
+}
+
+Pathfinder::Node& Pathfinder::GetNode(int index) {
+  Node& node = nodes_[index];
+  if (node.generation != generation_) {
+    node = Node{generation_, INT_MAX, kUnvisited, kUnvisited};
+  }
+  return node;
+}
+
+void Pathfinder::Relax(const Point& square, int parent, int cost,
+                       const Point& target, const MoveCosts& costs) {
+  const int index = Index(square);
+  Node& node = GetNode(index);
+  // The heuristic is consistent, so closed nodes are final.
+  if (node.heap_index == kClosed || cost >= node.cost) {
+    return;
+  }
+  node.cost = cost;
+  node.parent = parent;
+  const int heuristic = GetOctileDistance(square, target, costs);
+  Push(HeapEntry{cost + heuristic, heuristic, index});
+}
+
+
+int Pathfinder::Jump(const JumpPointTable& table, const Point& square,
+                     int direction, const Point& target) const {
+  // Negative distances count the free squares before a wall.
+  const int distance = table.GetDistance(square, direction);
+  const Point& step = JumpPointTable::kDirections[direction];
+  const Point diff = target - square;
+  const int along_x = diff.x*step.x;
+  const int along_y = diff.y*step.y;
+  // Stop early at the target if it is ahead, or, for diagonal steps, at the
+  // square from which it is straight ahead, if the scan gets that far.
+  int target_steps = 0;
+  if (step.x == 0 || step.y == 0) {
+    if ((step.x == 0 ? diff.x : diff.y) == 0) {
+      target_steps = along_x + along_y;
+    }
+  } else if (along_x > 0 && along_y > 0) {
+    target_steps = min(along_x, along_y);
+  }
+  if (target_steps > 0 && target_steps <= abs(distance)) {
+    return target_steps;
+  }
+  return max(distance, 0);
+}
+
+void Pathfinder::Push(const HeapEntry& entry) {
+  Node& node = nodes_[entry.index];
+  if (node.heap_index < 0) {
+    node.heap_index = heap_.size();
+    heap_.push_back(entry);
+  } else {
+    // Lowering a node's cost never raises its estimate.
+    ASSERT(!(heap_[node.heap_index] < entry));
+    heap_[node.heap_index] = entry;
+  }
+  SiftUp(node.heap_index);
+}
+
+Pathfinder::HeapEntry Pathfinder::Pop() {
+  const HeapEntry result = heap_[0];
+  nodes_[result.index].heap_index = kClosed;
+  heap_[0] = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty()) {
+    nodes_[heap_[0].index].heap_index = 0;
+    SiftDown(0);
+  }
+  return result;
+}
+
+void Pathfinder::SiftUp(int i) {
+  const HeapEntry entry = heap_[i];
+  while (i > 0) {
+    const int parent = (i - 1)/2;
+    if (!(entry < heap_[parent])) {
+      break;
+    }
+    heap_[i] = heap_[parent];
+    nodes_[heap_[i].index].heap_index = i;
+    i = parent;
+  }
+  heap_[i] = entry;
+  nodes_[entry.index].heap_index = i;
+}
+
+void Pathfinder::SiftDown(int i) {
+  const HeapEntry entry = heap_[i];
+  const int size = heap_.size();
+  while (true) {
+    int child = 2*i + 1;
+    if (child >= size) {
+      break;
+    } else if (child + 1 < size && heap_[child + 1] < heap_[child]) {
+      child += 1;
+    }
+    if (!(heap_[child] < entry)) {
+      break;
+    }
+    heap_[i] = heap_[child];
+    nodes_[heap_[i].index].heap_index = i;
+    i = child;
+  }
+  heap_[i] = entry;
+  nodes_[entry.index].heap_index = i;
+}
+
+}  // namespace engine
+}  // namespace babel
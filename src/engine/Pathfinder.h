@@ -0,0 +1,147 @@
+// Pathfinder finds cheapest paths between two squares on a TileMap with A*.
+// Paths are 8-connected, and the cost of each step depends on the creature
+// taking it, through MoveCosts, so that different creatures can route around
+// doors or take them. The search uses an octile-distance heuristic, which is
+// exact on an open map and never overestimates, so paths are always optimal.
+//
+// Queries do not allocate once the pathfinder's scratch space has grown. The
+// per-square search state lives in flat arrays that are stamped with the
+// query's generation, so starting a new query does not clear them, and the
+// open set is a binary heap that tracks each square's position in it, so a
+// square's cost can be lowered in place. Tiles are read from the map on each
+// query, so tile changes need no bookkeeping.
+//
+// FindJumpPointPath runs Jump Point Search (JPS+) instead, over the map's
+// JumpPointTable, which the first query builds. It only walks on free squares
+// and only uses MoveCosts' step costs, but it expands far fewer squares than
+// A* on open maps, as it skips straight across open regions from one jump
+// point to the next.
+//
+// A pathfinder is not thread-safe. Each thread should use its own.
+
+#ifndef __BABEL_ENGINE_PATHFINDER_H__
+#define __BABEL_ENGINE_PATHFINDER_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/point.h"
+#include "engine/JumpPointTable.h"
+#include "engine/TileMap.h"
+
+namespace babel {
+namespace engine {
+
+struct MoveCosts {
+  static const int kImpassable = -1;
+
+  // The costs of an orthogonal and a diagonal step. For the heuristic to be
+  // admissible, a diagonal step must cost between one and two orthogonal steps.
+  int orthogonal;
+  int diagonal;
+  // The extra cost of stepping onto a closed door or fence, or kImpassable if
+  // the creature cannot open it.
+  int door;
+  int fence;
+};
+
+// The costs used by NPCs chasing the player, which match FlowField's.
+static const MoveCosts kDefaultMoveCosts = {2, 3, 2, 2};
+
+// Returns the cost of a step onto a square with the given tile, or
+// MoveCosts::kImpassable if the step is not allowed.
+int GetStepCost(Tile tile, bool diagonal, const MoveCosts& costs);
+
+// Returns the cost of the cheapest path between the squares on an open map,
+// which is a lower bound on the cost of any path between them.
+int GetOctileDistance(const Point& a, const Point& b, const MoveCosts& costs);
+
+class Pathfinder {
+ public:
+  // Does NOT take ownership of the map, which must outlive the pathfinder.
+  Pathfinder(const TileMap& map);
+
+  // Returns false if there is no path from the source to the target. If there
+  // is, fills path with the squares along it, from the first step to the
+  // target. The path is empty if the source is the target.
+  bool FindPath(const Point& source, const Point& target,
+                const MoveCosts& costs, std::vector<Point>* path);
+
+  // Equivalent to FindPath with impassable doors and fences, but faster on
+  // open maps. A diagonal step must cost strictly between one and two
+  // orthogonal steps.
+  bool FindJumpPointPath(const Point& source, const Point& target,
+                         const MoveCosts& costs, std::vector<Point>* path);
+
+  // The number of squares the last query expanded, for benchmarking.
+  int GetNumExpanded() const { return num_expanded_; }
+
+ private:
+  static const int kUnvisited = -1;
+  static const int kClosed = -2;
+
+  struct Node {
+    uint32_t generation;
+    int cost;
+    int parent;
+    // The node's position in heap_, or kUnvisited or kClosed.
+    int heap_index;
+  };
+
+  // Heap entries carry their priorities, so that sifting does not touch the
+  // nodes. Ties in the estimated total cost go to the entry nearer the target.
+  struct HeapEntry {
+    int estimate;
+    int heuristic;
+    int index;
+
+    bool operator<(const HeapEntry& other) const {
+      return estimate < other.estimate ||
+             (estimate == other.estimate && heuristic < other.heuristic);
+    }
+  };
+
+  bool InBounds(const Point& square) const {
+    return (0 <= square.x && square.x < size_.x &&
+            0 <= square.y && square.y < size_.y);
+  }
+  // Nodes are laid out like TileMap's tiles.
+  int Index(const Point& square) const { return square.x*size_.y + square.y; }
+
+  // Resets the search state and pushes the source onto the heap.
+  void StartSearch(const Point& source, const Point& target,
+                   const MoveCosts& costs);
+  // Fills path with the squares from the source to the target, including any
+  // squares skipped between consecutive nodes.
+  void GetPath(int source_index, int target_index, std::vector<Point>* path);
+
+  // Returns the node, resetting it if it was last touched by an older query.
+  Node& GetNode(int index);
+  // Lowers the cost of reaching the square through the given parent, if that
+  // is cheaper than the best way found so far.
+  void Relax(const Point& square, int parent, int cost, const Point& target,
+             const MoveCosts& costs);
+
+  // Returns the number of steps that jump point search takes from the square
+  // in the given direction, or 0 if it stops without finding a jump point.
+  int Jump(const JumpPointTable& table, const Point& square, int direction,
+           const Point& target) const;
+
+  // Pushes a node onto the heap, or moves it up if it is already on it.
+  void Push(const HeapEntry& entry);
+  HeapEntry Pop();
+  void SiftUp(int i);
+  void SiftDown(int i);
+
+  const TileMap& map_;
+  const Point size_;
+  uint32_t generation_;
+  int num_expanded_;
+  std::vector<Node> nodes_;
+  std::vector<HeapEntry> heap_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_PATHFINDER_H__
@@ -0,0 +1,9 @@
+#include "engine/PermissiveFov.h"
+
+namespace babel {
+namespace engine {
+
+thread_local PermissiveFov gPermissiveFov;
+
+}  // namespace engine
+}  // namespace babel
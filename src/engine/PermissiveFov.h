@@ -0,0 +1,264 @@
+// PermissiveFov is a port of the permissive-fov library's algorithm (see
+// permissive-fov/permissive-fov.cc) that visits exactly the same squares.
+//
+// The library reaches the map through C function pointers and a void*
+// context, and allocates list nodes for its fields and bumps on every scan.
+// Here, the map is a template parameter, so its IsBlocked and Visit calls are
+// inlined, and fields and bumps live in vectors that a PermissiveFov instance
+// reuses across calls. Once those vectors have grown to fit the largest radius
+// used, a scan does no heap allocation at all.
+//
+// Fields are kept in a sorted vector instead of a list and referred to by
+// index; there are only a few active fields at a time, so shifting them on
+// insert and erase is cheaper than chasing list nodes. Bumps are appended to
+// per-quadrant arenas and refer to their parents by index.
+
+#ifndef __BABEL_ENGINE_PERMISSIVE_FOV_H__
+#define __BABEL_ENGINE_PERMISSIVE_FOV_H__
+
+#include <algorithm>
+#include <vector>
+
+#include "base/point.h"
+
+namespace babel {
+namespace engine {
+
+class PermissiveFov {
+ public:
+  // Computes field-of-vision from the given source, out to radius squares in
+  // x- and y-coordinate. The map type must provide these two methods:
+  //
+  //   bool IsBlocked(const Point& square) const;
+  //   void Visit(const Point& square);
+  //
+  // Visit is called exactly once for each visible square, including the
+  // source. IsBlocked may be called for squares outside the radius (and
+  // outside the map), and must return true for squares off the map.
+  template<typename T>
+  void Compute(const Point& source, int radius, T* map);
+
+  // Computes field-of-vision in one quadrant, whose coordinates are +/-1.
+  // Compute is equivalent to doing so for all four quadrants. Squares on the
+  // axes are visited in only one of the two quadrants that contain them: the
+  // source and the x-axis in (1, 1) and (-1, -1), and the y-axis in (-1, 1)
+  // and (1, -1).
+  template<typename T>
+  void ComputeQuadrant(const Point& source, const Point& quadrant, int radius,
+                       T* map);
+
+ private:
+  struct Line {
+    bool IsBelow(const Point& point) const {
+      return RelativeSlope(point) > 0;
+    }
+    bool IsBelowOrContains(const Point& point) const {
+      return RelativeSlope(point) >= 0;
+    }
+    bool IsAbove(const Point& point) const {
+      return RelativeSlope(point) < 0;
+    }
+    bool IsAboveOrContains(const Point& point) const {
+      return RelativeSlope(point) <= 0;
+    }
+    bool Contains(const Point& point) const {
+      return RelativeSlope(point) == 0;
+    }
+    int RelativeSlope(const Point& point) const {
+      return (far.y - near.y)*(far.x - point.x) -
+             (far.y - point.y)*(far.x - near.x);
+    }
+
+    Point near;
+    Point far;
+  };
+
+  struct Bump {
+    Point location;
+    int parent;
+  };
+
+  struct Field {
+    Line steep;
+    Line shallow;
+    int steep_bump;
+    int shallow_bump;
+  };
+
+  // Visits a square, starting from the field at index current, and returns
+  // the index of the field to continue from for the rest of its outline.
+  template<typename T>
+  int VisitSquare(const Point& source, const Point& quadrant,
+                  const Point& dest, int current, T* map);
+  template<typename T>
+  bool ActIsBlocked(const Point& source, const Point& quadrant,
+                    const Point& dest, T* map);
+
+  // Removes the field at the given index if it has narrowed to nothing.
+  // Returns true if the field was removed.
+  bool CheckField(int index);
+  void AddShallowBump(const Point& point, int index);
+  void AddSteepBump(const Point& point, int index);
+
+  // fields_ is sorted from shallow to steep.
+  std::vector<Field> fields_;
+  std::vector<Bump> steep_bumps_;
+  std::vector<Bump> shallow_bumps_;
+};
+
+// Each thread reuses this PermissiveFov, so computing a field of vision, a
+// line of sight, or a visible set does not allocate once its scratch space
+// has grown to fit. Scans must not be nested: a map's Visit and IsBlocked
+// must not start another scan on the same thread.
+extern thread_local PermissiveFov gPermissiveFov;
+
+template<typename T>
+void PermissiveFov::Compute(const Point& source, int radius, T* map) {
+  ComputeQuadrant(source, Point(1, 1), radius, map);
+  ComputeQuadrant(source, Point(-1, 1), radius, map);
+  ComputeQuadrant(source, Point(-1, -1), radius, map);
+  ComputeQuadrant(source, Point(1, -1), radius, map);
+}
+
+template<typename T>
+void PermissiveFov::ComputeQuadrant(const Point& source, const Point& quadrant,
+                                    int radius, T* map) {
+  const Point extent(std::max(radius, 0), std::max(radius, 0));
+  fields_.clear();
+  steep_bumps_.clear();
+  shallow_bumps_.clear();
+  fields_.push_back(Field{Line{Point(1, 0), Point(0, extent.y)},
+                          Line{Point(0, 1), Point(extent.x, 0)}, -1, -1});
+
+  // Visit the source square exactly once (in the first quadrant).
+  if (quadrant.x == 1 && quadrant.y == 1) {
+    ActIsBlocked(source, quadrant, Point(0, 0), map);
+  }
+
+  // Visit the squares in each diagonal outline in order, from shallow to
+  // steep, advancing through the sorted fields as we go.
+  const int max_i = extent.x + extent.y;
+  for (int i = 1; i <= max_i && !fields_.empty(); i++) {
+    const int start_j = std::max(0, i - extent.x);
+    const int max_j = std::min(i, extent.y);
+    int current = 0;
+    for (int j = start_j; j <= max_j && current < (int)fields_.size(); j++) {
+      current = VisitSquare(source, quadrant, Point(i - j, j), current, map);
+    }
+  }
+}
+
+template<typename T>
+int PermissiveFov::VisitSquare(const Point& source, const Point& quadrant,
+                               const Point& dest, int current, T* map) {
+  const Point top_left(dest.x, dest.y + 1);
+  const Point bottom_right(dest.x + 1, dest.y);
+  // Skip the fields that this square is entirely above. If it is above all
+  // of them, then so is the rest of its outline.
+  while (current < (int)fields_.size() &&
+         fields_[current].steep.IsBelowOrContains(bottom_right)) {
+    current++;
+  }
+  if (current == (int)fields_.size()) {
+    return current;
+  }
+  if (fields_[current].shallow.IsAboveOrContains(top_left)) {
+    // The square is entirely below the current field.
+    return current;
+  }
+  if (!ActIsBlocked(source, quadrant, dest, map)) {
+    return current;
+  }
+
+  // The square is blocked, so it narrows, ends, or splits the current field.
+  const Field& field = fields_[current];
+  const bool shallow_hit = field.shallow.IsAbove(bottom_right);
+  const bool steep_hit = field.steep.IsBelow(top_left);
+  if (shallow_hit && steep_hit) {
+    fields_.erase(fields_.begin() + current);
+  } else if (shallow_hit) {
+    AddShallowBump(top_left, current);
+    CheckField(current);
+  } else if (steep_hit) {
+    AddSteepBump(bottom_right, current);
+    CheckField(current);
+  } else {
+    // Split the field in two around the square. Inserting may reallocate,
+    // so the field must be copied first.
+    const Field copy = field;
+    const int shallower = current;
+    fields_.insert(fields_.begin() + shallower, copy);
+    int steeper = shallower + 1;
+    AddSteepBump(bottom_right, shallower);
+    if (CheckField(shallower)) {
+      steeper--;
+    }
+    AddShallowBump(top_left, steeper);
+    CheckField(steeper);
+    current = steeper;
+  }
+  return current;
+}
+
+template<typename T>
+bool PermissiveFov::ActIsBlocked(const Point& source, const Point& quadrant,
+                                 const Point& dest, T* map) {
+  const Point square(source.x + dest.x*quadrant.x,
+                     source.y + dest.y*quadrant.y);
+  const bool result = map->IsBlocked(square);
+  // Squares on the axes are shared by two quadrants. Only visit them once.
+  const bool shared = (quadrant.x*quadrant.y == 1 ?
+                       dest.x == 0 && dest.y != 0 :
+                       dest.y == 0 && dest.x != 0);
+  if (!shared) {
+    map->Visit(square);
+  }
+  return result;
+}
+
+inline bool PermissiveFov::CheckField(int index) {
+  // If the field's lines are colinear and pass through either extremity of
+  // the source square, it is empty and can be removed.
+  const Field& field = fields_[index];
+  if (field.shallow.Contains(field.steep.near) &&
+      field.shallow.Contains(field.steep.far) &&
+      (field.shallow.Contains(Point(0, 1)) ||
+       field.shallow.Contains(Point(1, 0)))) {
+    fields_.erase(fields_.begin() + index);
+    return true;
+  }
+  return false;
+}
+
+inline void PermissiveFov::AddShallowBump(const Point& point, int index) {
+  Field& field = fields_[index];
+  field.shallow.far = point;
+  shallow_bumps_.push_back(Bump{point, field.shallow_bump});
+  field.shallow_bump = shallow_bumps_.size() - 1;
+  // If any of the field's steep bumps are now above the shallow line, the
+  // line has to pivot around them.
+  for (int bump = field.steep_bump; bump >= 0;
+       bump = steep_bumps_[bump].parent) {
+    if (field.shallow.IsAbove(steep_bumps_[bump].location)) {
+      field.shallow.near = steep_bumps_[bump].location;
+    }
+  }
+}
+
+inline void PermissiveFov::AddSteepBump(const Point& point, int index) {
+  Field& field = fields_[index];
+  field.steep.far = point;
+  steep_bumps_.push_back(Bump{point, field.steep_bump});
+  field.steep_bump = steep_bumps_.size() - 1;
+  for (int bump = field.shallow_bump; bump >= 0;
+       bump = shallow_bumps_[bump].parent) {
+    if (field.steep.IsBelow(shallow_bumps_[bump].location)) {
+      field.steep.near = shallow_bumps_[bump].location;
+    }
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_PERMISSIVE_FOV_H__
@@ -0,0 +1,172 @@
+#include "engine/PotentiallyVisibleSet.h"
+
+#include <cstdlib>
+
+#include "base/debug.h"
+#include "engine/FieldOfVision.h"
+#include "engine/PermissiveFov.h"
+
+using std::vector;
+
+namespace babel {
+namespace engine {
+
+namespace {
+
+static const uint32_t kNoSet = UINT32_MAX;
+
+// Collects the squares visible from a source, out to the edge of the scan's
+// box rather than a disc.
+class VisibleSquares {
+ public:
+  VisibleSquares(const BitGrid& opacity, vector<Point>* squares)
+      : opacity_(opacity), squares_(squares) {}
+
+  bool IsBlocked(const Point& square) const {
+    return !opacity_.InBounds(square) || opacity_.Get(square);
+  }
+
+  void Visit(const Point& square) {
+    if (opacity_.InBounds(square)) {
+      squares_->push_back(square);
+    }
+  }
+
+ private:
+  const BitGrid& opacity_;
+  vector<Point>* squares_;
+};
+
+void AppendRun(int run, vector<uint8_t>* runs) {
+  while (run > 255) {
+    runs->push_back(255);
+    runs->push_back(0);
+    run -= 255;
+  }
+  runs->push_back(run);
+}
+
+}  // namespace
+
+PotentiallyVisibleSet::PotentiallyVisibleSet(const BitGrid& opacity, int radius)
+    : radius_(radius), opacity_(opacity),
+      offsets_(opacity.GetSize().x*opacity.GetSize().y, kNoSet),
+      garbage_(0) {
+  ASSERT(radius >= 0);
+  for (int y = 0; y < opacity_.GetSize().y; y++) {
+    for (int x = 0; x < opacity_.GetSize().x; x++) {
+      ComputeSet(Point(x, y));
+    }
+  }
+}
+
+bool PotentiallyVisibleSet::IsSquareVisible(
+    const Point& source, const Point& square) const {
+  ASSERT(HasSource(source));
+  const Point diff = square - source;
+  if (abs(diff.x) > radius_ || abs(diff.y) > radius_) {
+    return false;
+  }
+  const int index = (diff.y + radius_)*(2*radius_ + 1) + diff.x + radius_;
+  const uint8_t* set = &runs_[offsets_[Index(source)]];
+  const int size = set[0] | (set[1] << 8);
+  bool visible = false;
+  int end = 0;
+  for (int i = 0; i < size; i++) {
+    end += set[i + 2];
+    if (index < end) {
+      return visible;
+    }
+    visible = !visible;
+  }
+  return false;
+}
+
+void PotentiallyVisibleSet::UpdateTile(const Point& square, bool blocked) {
+  if (!opacity_.InBounds(square) || opacity_.Get(square) == blocked) {
+    return;
+  }
+  if (blocked) {
+    opacity_.Set(square);
+  } else {
+    opacity_.Reset(square);
+  }
+  // A source's set can only change if its scan reached the square. Squares
+  // on the source's axes are checked by two quadrants but visited by one, so
+  // sources in line with the square are always recomputed.
+  vector<Point> sources;
+  VisibleSquares visitor(opacity_, &sources);
+  gPermissiveFov.Compute(square, radius_, &visitor);
+  for (int i = -radius_; i <= radius_; i++) {
+    if (i != 0) {
+      visitor.Visit(square + Point(i, 0));
+      visitor.Visit(square + Point(0, i));
+    }
+  }
+  for (const Point& source : sources) {
+    ComputeSet(source);
+  }
+  MaybeCompact();
+}
+
+size_t PotentiallyVisibleSet::GetMemoryUsage() const {
+  const Point& size = opacity_.GetSize();
+  return (sizeof(uint32_t)*offsets_.capacity() + runs_.capacity() +
+          sizeof(uint64_t)*opacity_.GetWordsPerRow()*size.y);
+}
+
+void PotentiallyVisibleSet::ComputeSet(const Point& source) {
+  uint32_t& offset = offsets_[Index(source)];
+  if (offset != kNoSet) {
+    garbage_ += 2 + (runs_[offset] | (runs_[offset + 1] << 8));
+    offset = kNoSet;
+  }
+  if (!HasSource(source)) {
+    return;
+  }
+  offset = runs_.size();
+  runs_.push_back(0);
+  runs_.push_back(0);
+  const FieldOfVision vision(opacity_, source, radius_);
+  const BitGrid& bits = vision.GetVisibleSquares();
+  bool visible = false;
+  int run = 0;
+  for (int y = 0; y < bits.GetSize().y; y++) {
+    for (int x = 0; x < bits.GetSize().x; x++) {
+      if (bits.Get(Point(x, y)) != visible) {
+        AppendRun(run, &runs_);
+        visible = !visible;
+        run = 0;
+      }
+      run += 1;
+    }
+  }
+  if (visible) {
+    AppendRun(run, &runs_);
+  }
+  const int size = runs_.size() - offset - 2;
+  ASSERT(size < (1 << 16));
+  runs_[offset] = size & 0xff;
+  runs_[offset + 1] = size >> 8;
+}
+
+void PotentiallyVisibleSet::MaybeCompact() {
+  if (2*garbage_ < runs_.size()) {
+    return;
+  }
+  vector<uint8_t> runs;
+  runs.reserve(runs_.size() - garbage_);
+  for (uint32_t& offset : offsets_) {
+    if (offset != kNoSet) {
+      const int size = 2 + (runs_[offset] | (runs_[offset + 1] << 8));
+      const uint32_t compacted = runs.size();
+      runs.insert(runs.end(), &runs_[offset], &runs_[offset] + size);
+      offset = compacted;
+    }
+  }
+  runs_.swap(runs);
+  garbage_ = 0;
+}
+
+}  // namespace engine
+}  // namespace babel
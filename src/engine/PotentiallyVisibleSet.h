@@ -0,0 +1,74 @@
+// PotentiallyVisibleSet precomputes, for each free square on a map, the set
+// of squares visible from it out to a fixed radius, so that visibility
+// queries between two squares do not need to run shadowcasting at all.
+//
+// Each source's set is the bit grid of a FieldOfVision with the set's radius,
+// run-length encoded in row-major order. A set is a 16-bit count of run bytes
+// followed by the runs, which alternate between hidden and visible squares,
+// starting with hidden. Runs longer than 255 are split with zero-length runs
+// of the other kind, and the final hidden run is dropped. A query walks one
+// source's runs, which number a few dozen at most for typical radii.
+//
+// Most of a map never changes, but doors open and fences go up. UpdateTile
+// recomputes only the sets of the sources that can see the changed square.
+// Permissive field-of-view is symmetric, so those are the squares visible from
+// the changed square, which a single scan finds.
+
+#ifndef __BABEL_ENGINE_POTENTIALLY_VISIBLE_SET_H__
+#define __BABEL_ENGINE_POTENTIALLY_VISIBLE_SET_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/bit_grid.h"
+#include "base/point.h"
+
+namespace babel {
+namespace engine {
+
+class PotentiallyVisibleSet {
+ public:
+  // opacity has a set bit for each blocked square on the map.
+  PotentiallyVisibleSet(const BitGrid& opacity, int radius);
+
+  int GetRadius() const { return radius_; }
+
+  // Returns true if there is a set for the given source, which is the case
+  // for every free square on the map.
+  bool HasSource(const Point& source) const {
+    return opacity_.InBounds(source) && !opacity_.Get(source);
+  }
+
+  // Returns true if the square is visible from the source, exactly as for
+  // FieldOfVision(opacity, source, radius).IsSquareVisible(square). The
+  // source must have a set.
+  bool IsSquareVisible(const Point& source, const Point& square) const;
+
+  // Must be called each time the tile at the given square changes.
+  void UpdateTile(const Point& square, bool blocked);
+
+  // Returns the number of bytes used by the sets and their index.
+  size_t GetMemoryUsage() const;
+
+ private:
+  int Index(const Point& square) const {
+    return square.y*opacity_.GetSize().x + square.x;
+  }
+
+  // Encodes and appends the source's set, or clears it if the source is
+  // blocked. The old encoding, if any, becomes garbage.
+  void ComputeSet(const Point& source);
+  void MaybeCompact();
+
+  const int radius_;
+  BitGrid opacity_;
+  // The offset of each square's set in runs_, or kNoSet if it is blocked.
+  std::vector<uint32_t> offsets_;
+  std::vector<uint8_t> runs_;
+  size_t garbage_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_POTENTIALLY_VISIBLE_SET_H__
@@ -0,0 +1,89 @@
+#include "engine/Scheduler.h"
+
+#include <algorithm>
+
+#include "base/debug.h"
+#include "engine/Sprite.h"
+
+namespace babel {
+namespace engine {
+
+const int Scheduler::kNumRounds;
+
+Scheduler::Scheduler() : buckets_(kNumRounds) {}
+
+void Scheduler::AddSprite(Sprite* sprite) {
+  ASSERT(sprite != nullptr);
+  ASSERT(orders_.find(sprite) == orders_.end());
+  // New sprites are ordered after all existing sprites, so they are visited
+  // in the round of the sprite that is currently acting, after it.
+  Schedule(sprite, round_, next_order_);
+  orders_[sprite] = next_order_;
+  next_order_ += 1;
+}
+
+void Scheduler::RemoveSprite(Sprite* sprite) {
+  ASSERT(sprite != nullptr);
+  const auto& it = orders_.find(sprite);
+  ASSERT(it != orders_.end());
+  removed_.insert(it->second);
+  orders_.erase(it);
+}
+
+Sprite* Scheduler::GetCurrentSprite() const {
+  ASSERT(!orders_.empty());
+  Settle();
+  const Entry& entry = buckets_[round_ % kNumRounds][index_];
+  ASSERT(entry.sprite->speed() == entry.speed);
+  return entry.sprite;
+}
+
+void Scheduler::AdvanceSprite() {
+  // If the current sprite was removed during its turn, its entry is dropped
+  // here. Settling would skip it and advance the next sprite instead.
+  if (settled_) {
+    const Entry& entry = buckets_[round_ % kNumRounds][index_];
+    if (!removed_.empty() && removed_.erase(entry.order) > 0) {
+      index_ += 1;
+      settled_ = false;
+      return;
+    }
+  }
+  ASSERT(!orders_.empty());
+  Settle();
+  const Entry entry = buckets_[round_ % kNumRounds][index_];
+  index_ += 1;
+  settled_ = false;
+  Schedule(entry.sprite, round_ + 1, entry.order);
+}
+
+void Scheduler::Schedule(Sprite* sprite, long long round, uint32_t order) {
+  // The sprite acts on the last of the visits returned by GainEnergy.
+  const long long next_round = round + sprite->GainEnergy() - 1;
+  ASSERT(next_round - round_ < kNumRounds);
+  buckets_[next_round % kNumRounds].push_back(
+      Entry{order, sprite->speed(), sprite});
+}
+
+void Scheduler::Settle() const {
+  // Some bucket holds a live sprite, so this stops within kNumRounds rounds.
+  while (true) {
+    Bucket& bucket = buckets_[round_ % kNumRounds];
+    while (index_ < (int)bucket.size() && !removed_.empty() &&
+           removed_.erase(bucket[index_].order) > 0) {
+      index_ += 1;
+    }
+    if (index_ < (int)bucket.size()) {
+      settled_ = true;
+      return;
+    }
+    bucket.clear();
+    index_ = 0;
+    round_ += 1;
+    Bucket& next = buckets_[round_ % kNumRounds];
+    std::sort(next.begin(), next.end());
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
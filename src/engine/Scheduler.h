@@ -0,0 +1,99 @@
+// Scheduler determines the order in which sprites take turns. It produces
+// exactly the same order as visiting the sprites round-robin and calling
+// GainEnergy on each one until it has the energy needed to move, but instead
+// of polling, it computes the round in which each sprite will next be ready.
+//
+// Sprites are kept in a calendar queue: a ring of buckets, one per upcoming
+// round, each holding the sprites that act in that round. A bucket is sorted
+// by order of insertion when its round starts, and its sprites then act in
+// that order. Getting the current sprite is O(1) amortized, and adding or
+// advancing a sprite is an append to a bucket, plus O(log k) for sorting a
+// round in which k sprites act. Removed sprites are skipped lazily, when
+// their round comes up.
+//
+// Polling costs one visit per sprite per round, so its cost per turn grows
+// with how long sprites wait between turns. At the game's creature speeds it
+// visits about eight sprites per turn and costs about the same as this queue;
+// for slow creatures, it is several times slower. schedbench compares them.
+
+#ifndef __BABEL_ENGINE_SCHEDULER_H__
+#define __BABEL_ENGINE_SCHEDULER_H__
+
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace babel {
+namespace engine {
+
+class Sprite;
+
+class Scheduler {
+ public:
+  Scheduler();
+
+  // Does NOT take ownership of the sprite. A sprite that is added while
+  // another sprite is acting will get its first turn later in the same round.
+  //
+  // A sprite's speed must not change while it waits for its turn: it gains
+  // the energy for all of its visits up to its next turn when it is
+  // scheduled, at the speed it had then. It may change on the sprite's own
+  // turn, before AdvanceSprite schedules the next one.
+  void AddSprite(Sprite* sprite);
+  void RemoveSprite(Sprite* sprite);
+
+  // Returns the next sprite to act, which has the energy needed to move.
+  // The sprite stays current until AdvanceSprite is called. If the current
+  // sprite is removed during its turn, AdvanceSprite just ends the turn.
+  Sprite* GetCurrentSprite() const;
+  void AdvanceSprite();
+
+  bool IsEmpty() const { return orders_.empty(); }
+
+ private:
+  // Sprites start with at least -kEnergyNeededToMove energy and gain at least
+  // 1 per visit, so no sprite is scheduled this many rounds ahead.
+  static const int kNumRounds = 512;
+
+  struct Entry {
+    uint32_t order;
+    // The speed that the sprite's energy was gained at.
+    int speed;
+    Sprite* sprite;
+
+    bool operator<(const Entry& other) const { return order < other.order; }
+  };
+  typedef std::vector<Entry> Bucket;
+
+  // Appends the sprite to the bucket for the round it will next act in, given
+  // that it will next be visited in round.
+  void Schedule(Sprite* sprite, long long round, uint32_t order);
+
+  // Moves the loop past removed sprites and finished rounds, so that the
+  // current entry is a live sprite. There must be at least one.
+  //
+  // Like the round-robin loop, this only moves on when the next sprite is
+  // needed, so sprites added before the first turn, or between turns, are
+  // scheduled from the round of the last sprite that acted.
+  void Settle() const;
+
+  // The loop's state is mutable so that GetCurrentSprite can settle it.
+  mutable std::vector<Bucket> buckets_;
+  // The round that the round-robin loop is in, and the position of the
+  // current sprite in that round's bucket. Before the first turn, the loop is
+  // in round 0, even if no sprite is ready to move in it.
+  mutable long long round_ = 0;
+  mutable int index_ = 0;
+  // True if the entry at index_ is the current sprite, which was live when
+  // the loop last settled on it.
+  mutable bool settled_ = false;
+  std::unordered_map<Sprite*,uint32_t> orders_;
+  mutable std::unordered_set<uint32_t> removed_;
+  uint32_t next_order_ = 0;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_SCHEDULER_H__
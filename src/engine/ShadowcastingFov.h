@@ -0,0 +1,182 @@
+// Shadowcasting field-of-view backends, which trade PermissiveFov's precision
+// for speed. Both scan outward from the source one row at a time, tracking the
+// range of slopes that is still lit and recursing when a wall splits it, so
+// they touch each visible square about once and do no heap allocation.
+//
+// RecursiveShadowcastingFov is Bjorn Bergstrom's algorithm, run over eight
+// octants. A square is visible if any part of it is within a lit range. It is
+// not symmetric: a sees b does not imply that b sees a.
+//
+// SymmetricShadowcastingFov is Albert Ford's variant, run over four quadrants.
+// Floor squares are visible only if their centers are within a lit range,
+// while walls are visible if any part of them is. This makes it symmetric for
+// floor squares, and it lights up fewer squares at wall corners.
+//
+// Both take the same map type as PermissiveFov. Squares on the boundaries
+// between octants or quadrants may be visited more than once.
+
+#ifndef __BABEL_ENGINE_SHADOWCASTING_FOV_H__
+#define __BABEL_ENGINE_SHADOWCASTING_FOV_H__
+
+#include "base/point.h"
+
+namespace babel {
+namespace engine {
+
+class RecursiveShadowcastingFov {
+ public:
+  // Computes field-of-vision from the given source, out to radius squares in
+  // x- and y-coordinate.
+  template<typename T>
+  void Compute(const Point& source, int radius, T* map);
+
+ private:
+  // Maps the octant's (column, row) coordinates to (dx, dy).
+  struct Octant {
+    int xx, xy, yx, yy;
+  };
+
+  // Scans rows from row to radius in one octant, with lit slopes in
+  // [end, start], measured as dx/dy from the source's center.
+  template<typename T>
+  void CastLight(const Point& source, const Octant& octant, int radius,
+                 int row, double start, double end, T* map);
+};
+
+class SymmetricShadowcastingFov {
+ public:
+  template<typename T>
+  void Compute(const Point& source, int radius, T* map);
+
+ private:
+  // Slopes are exact fractions, so that tie-breaking when rounding square
+  // centers is exact too. The denominator is always positive.
+  struct Slope {
+    int num;
+    int den;
+  };
+
+  // Maps the quadrant's (depth, column) coordinates to (dx, dy).
+  struct Quadrant {
+    int dx_depth, dx_col, dy_depth, dy_col;
+  };
+
+  template<typename T>
+  void Scan(const Point& source, const Quadrant& quadrant, int radius,
+            int depth, Slope start, Slope end, T* map);
+};
+
+template<typename T>
+void RecursiveShadowcastingFov::Compute(
+    const Point& source, int radius, T* map) {
+  static const Octant kOctants[] = {
+      {1, 0, 0, 1}, {0, 1, 1, 0}, {0, -1, 1, 0}, {-1, 0, 0, 1},
+      {-1, 0, 0, -1}, {0, -1, -1, 0}, {0, 1, -1, 0}, {1, 0, 0, -1}};
+  map->Visit(source);
+  for (const Octant& octant : kOctants) {
+    CastLight(source, octant, radius, 1, 1.0, 0.0, map);
+  }
+}
+
+template<typename T>
+void RecursiveShadowcastingFov::CastLight(
+    const Point& source, const Octant& octant, int radius,
+    int row, double start, double end, T* map) {
+  if (start < end) {
+    return;
+  }
+  double next_start = start;
+  for (int j = row; j <= radius; j++) {
+    bool blocked = false;
+    for (int i = -j; i <= 0; i++) {
+      const double left = (i - 0.5)/(-j + 0.5);
+      const double right = (i + 0.5)/(-j - 0.5);
+      if (start < right) {
+        continue;
+      } else if (end > left) {
+        break;
+      }
+      const Point square(source.x + i*octant.xx + -j*octant.xy,
+                         source.y + i*octant.yx + -j*octant.yy);
+      map->Visit(square);
+      const bool square_blocked = map->IsBlocked(square);
+      if (blocked) {
+        if (square_blocked) {
+          next_start = right;
+        } else {
+          blocked = false;
+          start = next_start;
+        }
+      } else if (square_blocked && j < radius) {
+        blocked = true;
+        CastLight(source, octant, radius, j + 1, start, left, map);
+        next_start = right;
+      }
+    }
+    if (blocked) {
+      return;
+    }
+  }
+}
+
+namespace internal {
+
+// Floor division for a positive divisor.
+inline int FloorDiv(int a, int b) {
+  return a >= 0 ? a/b : -((b - 1 - a)/b);
+}
+
+}  // namespace internal
+
+template<typename T>
+void SymmetricShadowcastingFov::Compute(
+    const Point& source, int radius, T* map) {
+  static const Quadrant kQuadrants[] = {
+      {0, 1, -1, 0}, {1, 0, 0, 1}, {0, 1, 1, 0}, {-1, 0, 0, 1}};
+  map->Visit(source);
+  for (const Quadrant& quadrant : kQuadrants) {
+    Scan(source, quadrant, radius, 1, Slope{-1, 1}, Slope{1, 1}, map);
+  }
+}
+
+template<typename T>
+void SymmetricShadowcastingFov::Scan(
+    const Point& source, const Quadrant& quadrant, int radius,
+    int depth, Slope start, Slope end, T* map) {
+  using internal::FloorDiv;
+  if (depth > radius) {
+    return;
+  }
+  // Columns from depth*start to depth*end, rounding ties toward the center.
+  const int min_col =
+      FloorDiv(2*depth*start.num + start.den, 2*start.den);
+  const int max_col =
+      -FloorDiv(end.den - 2*depth*end.num, 2*end.den);
+  int previous = -1;
+  for (int col = min_col; col <= max_col; col++) {
+    const Point square(
+        source.x + depth*quadrant.dx_depth + col*quadrant.dx_col,
+        source.y + depth*quadrant.dy_depth + col*quadrant.dy_col);
+    const int blocked = map->IsBlocked(square);
+    // Floor squares must have centers in [depth*start, depth*end].
+    if (blocked || (col*start.den >= depth*start.num &&
+                    col*end.den <= depth*end.num)) {
+      map->Visit(square);
+    }
+    if (previous == 1 && !blocked) {
+      start = Slope{2*col - 1, 2*depth};
+    } else if (previous == 0 && blocked) {
+      Scan(source, quadrant, radius, depth + 1,
+           start, Slope{2*col - 1, 2*depth}, map);
+    }
+    previous = blocked;
+  }
+  if (previous == 0) {
+    Scan(source, quadrant, radius, depth + 1, start, end, map);
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_SHADOWCASTING_FOV_H__
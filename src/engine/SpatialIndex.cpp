@@ -0,0 +1,186 @@
+#include "engine/SpatialIndex.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "base/debug.h"
+
+using std::max;
+using std::min;
+using std::vector;
+
+namespace babel {
+namespace engine {
+namespace {
+
+Point Clamp(const Point& point, const Point& lower, const Point& upper) {
+  return Point(min(max(point.x, lower.x), upper.x),
+               min(max(point.y, lower.y), upper.y));
+}
+
+int GetDistanceSquared(const Point& a, const Point& b) {
+  const Point diff = a - b;
+  return diff.x*diff.x + diff.y*diff.y;
+}
+
+}  // namespace
+
+const int SpatialIndex::kCellSize;
+
+SpatialIndex::SpatialIndex(const Point& size)
+    : size_(size), cells_((size.x + kCellSize - 1)/kCellSize,
+                          (size.y + kCellSize - 1)/kCellSize),
+      num_sprites_(0), buckets_(cells_.x*cells_.y) {}
+
+void SpatialIndex::AddSprite(const Point& square, sid id) {
+  ASSERT(id != kInvalidSid);
+  ASSERT(0 <= square.x && square.x < size_.x &&
+         0 <= square.y && square.y < size_.y);
+  buckets_[CellIndex(square)].push_back(Entry{square, id});
+  num_sprites_ += 1;
+}
+
+void SpatialIndex::RemoveSprite(const Point& square) {
+  Bucket& bucket = buckets_[CellIndex(square)];
+  for (Entry& entry : bucket) {
+    if (entry.square == square) {
+      entry = bucket.back();
+      bucket.pop_back();
+      num_sprites_ -= 1;
+      return;
+    }
+  }
+  ASSERT(false);
+}
+
+void SpatialIndex::MoveSprite(const Point& from, const Point& to) {
+  ASSERT(0 <= to.x && to.x < size_.x && 0 <= to.y && to.y < size_.y);
+  const bool same_cell = CellIndex(from) == CellIndex(to);
+  for (Entry& entry : buckets_[CellIndex(from)]) {
+    if (entry.square == from) {
+      if (same_cell) {
+        entry.square = to;
+      } else {
+        const sid id = entry.id;
+        RemoveSprite(from);
+        AddSprite(to, id);
+      }
+      return;
+    }
+  }
+  ASSERT(false);
+}
+
+template <typename Predicate>
+void SpatialIndex::Collect(const Point& first, const Point& last,
+                           const Predicate& predicate,
+                           vector<sid>* result) const {
+  for (int x = first.x; x <= last.x; x++) {
+    for (int y = first.y; y <= last.y; y++) {
+      for (const Entry& entry : buckets_[x*cells_.y + y]) {
+        if (predicate(entry)) {
+          result->push_back(entry.id);
+        }
+      }
+    }
+  }
+}
+
+void SpatialIndex::GetSpritesInRadius(const Point& center, int radius,
+                                      vector<sid>* result) const {
+  result->clear();
+  if (radius <= 0 || num_sprites_ == 0) {
+    return;
+  }
+  const Point extent(radius - 1, radius - 1);
+  const Point last = size_ - Point(1, 1);
+  const Point first_cell = Clamp(center - extent, Point(0, 0), last)/kCellSize;
+  const Point last_cell = Clamp(center + extent, Point(0, 0), last)/kCellSize;
+  const int limit = radius*radius;
+  Collect(first_cell, last_cell, [&](const Entry& entry) {
+    return GetDistanceSquared(entry.square, center) < limit;
+  }, result);
+}
+
+void SpatialIndex::GetSpritesInRect(const Point& position, const Point& size,
+                                    vector<sid>* result) const {
+  result->clear();
+  const Point upper = position + size;
+  const Point first = Clamp(position, Point(0, 0), size_);
+  const Point last = Clamp(upper, Point(0, 0), size_) - Point(1, 1);
+  if (first.x > last.x || first.y > last.y || num_sprites_ == 0) {
+    return;
+  }
+  Collect(first/kCellSize, last/kCellSize, [&](const Entry& entry) {
+    const Point& square = entry.square;
+    return (position.x <= square.x && square.x < upper.x &&
+            position.y <= square.y && square.y < upper.y);
+  }, result);
+}
+
+void SpatialIndex::GetNearestSprites(const Point& center, int k,
+                                     vector<sid>* result) const {
+  result->clear();
+  if (k <= 0 || num_sprites_ == 0) {
+    return;
+  }
+  k = min(k, num_sprites_);
+  candidates_.clear();
+  const Point cell =
+      Clamp(center/kCellSize, Point(0, 0), cells_ - Point(1, 1));
+
+  // Search rings of cells around the center's cell. After ring r, every
+  // sprite not yet seen is outside the box of cells within r of that cell,
+  // and so at least one square past the nearest side of the box that still
+  // has cells beyond it. Once the k-th nearest candidate is strictly closer
+  // than that, no unseen sprite can displace it, even on a tie.
+  for (int r = 0;; r++) {
+    const Point lower = cell - Point(r, r);
+    const Point upper = cell + Point(r, r);
+    for (int x = max(lower.x, 0); x <= min(upper.x, cells_.x - 1); x++) {
+      // Inner columns of the ring only contribute their top and bottom cells.
+      const bool side = (x == lower.x || x == upper.x);
+      for (int y = max(lower.y, 0); y <= min(upper.y, cells_.y - 1); y++) {
+        if (!side && y != lower.y && y != upper.y) {
+          continue;
+        }
+        for (const Entry& entry : buckets_[x*cells_.y + y]) {
+          candidates_.push_back(std::make_pair(
+              GetDistanceSquared(entry.square, center), entry.id));
+        }
+      }
+    }
+
+    int gap = INT_MAX;
+    if (lower.x > 0) {
+      gap = min(gap, center.x - lower.x*kCellSize + 1);
+    }
+    if (upper.x < cells_.x - 1) {
+      gap = min(gap, (upper.x + 1)*kCellSize - center.x);
+    }
+    if (lower.y > 0) {
+      gap = min(gap, center.y - lower.y*kCellSize + 1);
+    }
+    if (upper.y < cells_.y - 1) {
+      gap = min(gap, (upper.y + 1)*kCellSize - center.y);
+    }
+    if (gap == INT_MAX) {
+      break;
+    } else if ((int)candidates_.size() >= k) {
+      std::nth_element(candidates_.begin(), candidates_.begin() + k - 1,
+                       candidates_.end());
+      if (candidates_[k - 1].first < gap*gap) {
+        break;
+      }
+    }
+  }
+
+  std::partial_sort(candidates_.begin(), candidates_.begin() + k,
+                    candidates_.end());
+  for (int i = 0; i < k; i++) {
+    result->push_back(candidates_[i].second);
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
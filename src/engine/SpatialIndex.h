@@ -0,0 +1,85 @@
+// SpatialIndex answers proximity queries over sprite positions: which sprites
+// are within a radius of a square, which are in a rectangle, and which are
+// nearest to a square. It is a uniform grid of buckets, each covering a
+// kCellSize x kCellSize block of squares and holding the ids and squares of
+// the sprites in that block, so a query only reads the buckets that overlap
+// its region instead of scanning every sprite or probing every square.
+//
+// Updates are O(1) plus a scan of one or two small buckets, and a move within
+// a block rewrites the entry in place. The owner must mirror every sprite
+// add, move, and removal, as it does for OccupancyGrid.
+//
+// Query results are written to an output vector, which is cleared first, and
+// are in no particular order, except for the nearest sprites, which are
+// sorted by distance and then by id.
+
+#ifndef __BABEL_ENGINE_SPATIAL_INDEX_H__
+#define __BABEL_ENGINE_SPATIAL_INDEX_H__
+
+#include <utility>
+#include <vector>
+
+#include "base/point.h"
+#include "engine/SpriteStore.h"
+
+namespace babel {
+namespace engine {
+
+class SpatialIndex {
+ public:
+  // Sprites must be placed on in-bounds squares, one sprite per square.
+  SpatialIndex(const Point& size);
+
+  void AddSprite(const Point& square, sid id);
+  void RemoveSprite(const Point& square);
+  void MoveSprite(const Point& from, const Point& to);
+
+  int size() const { return num_sprites_; }
+
+  // Returns the sprites less than radius away from the center, measured in
+  // Euclidean distance, which are those inside a vision mask of that radius.
+  void GetSpritesInRadius(const Point& center, int radius,
+                          std::vector<sid>* result) const;
+
+  // Returns the sprites on squares in [position, position + size).
+  void GetSpritesInRect(const Point& position, const Point& size,
+                        std::vector<sid>* result) const;
+
+  // Returns the k sprites nearest to the center, or all of them if there are
+  // fewer than k. The center's own sprite, if any, comes first.
+  void GetNearestSprites(const Point& center, int k,
+                         std::vector<sid>* result) const;
+
+ private:
+  static const int kCellSize = 8;
+
+  struct Entry {
+    Point square;
+    sid id;
+  };
+  typedef std::vector<Entry> Bucket;
+
+  // Cells are laid out like TileMap's tiles.
+  int CellIndex(const Point& square) const {
+    return (square.x/kCellSize)*cells_.y + square.y/kCellSize;
+  }
+
+  // Appends the ids of the entries in cells [first, last] for which the
+  // predicate holds. first and last are cell coordinates inside the grid.
+  template <typename Predicate>
+  void Collect(const Point& first, const Point& last,
+               const Predicate& predicate, std::vector<sid>* result) const;
+
+  const Point size_;
+  // The dimensions of the grid of cells.
+  const Point cells_;
+  int num_sprites_;
+  std::vector<Bucket> buckets_;
+  // Scratch space for nearest-sprite queries.
+  mutable std::vector<std::pair<int,sid>> candidates_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_SPATIAL_INDEX_H__
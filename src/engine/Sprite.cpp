@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "engine/Action.h"
+#include "engine/FlowField.h"
 #include "engine/GameState.h"
 
 using std::string;
@@ -14,38 +15,48 @@ namespace engine {
 namespace {
 
 static const int kFineness = 1 << 8;
-static const int kEnergyNeededToMove = 240;
-// Global counter used to assign sprites unique ids.
-static sid gIdCounter;
 
 bool AreAdjacent(const Sprite& sprite, const Sprite& other) {
-  const Point diff = sprite.square - other.square;
+  const Point diff = sprite.square() - other.square();
   return (abs(diff.x) <= 1 && abs(diff.y) <= 1);
 }
 
 int ScoreMove(const Sprite& sprite, const GameState& game_state,
-              const Point& move) {
-  Point square = sprite.square + move;
+              const FlowField* field, const Point& move) {
+  Point square = sprite.square() + move;
+  // Moves onto closed doors are allowed if the flow field leads through them.
   if ((move.x != 0 || move.y != 0) &&
-      (game_state.map->IsSquareBlocked(square) ||
-       game_state.IsSquareOccupied(square))) {
+      game_state.IsSquareBlockedOrOccupied(square) &&
+      !(field != nullptr && game_state.map->IsSquareBlocked(square) &&
+        field->GetDistance(square) != FlowField::kUnreachable)) {
     return INT_MIN;
   }
-  // Move toward the player if they are visible. Otherwise, move randomly.
-  const int radius = sprite.creature->stats.vision_radius;
-  if (game_state.player_vision->IsSquareVisible(sprite.square, radius)) {
-    return -kFineness*(game_state.player->square - square).length();
+  // Follow the flow field toward the player if they are visible and there is
+  // a path to them. Otherwise, move toward the player if they are visible, or
+  // move randomly if they are not.
+  if (field != nullptr) {
+    return -field->GetDistance(square);
+  } else if (game_state.CanSpriteSee(sprite, game_state.player->square())) {
+    return -kFineness*(game_state.player->square() - square).length();
   }
   return 0;
 }
 
-const Point GetBestMove(const Sprite& sprite, const GameState& game_state) {
+const Point GetBestMove(const Sprite& sprite, const GameState& game_state,
+                        RNG* rng) {
+  const FlowField* field = nullptr;
+  if (game_state.CanSpriteSee(sprite, game_state.player->square())) {
+    field = &game_state.GetPlayerFlowField();
+    if (field->GetDistance(sprite.square()) == FlowField::kUnreachable) {
+      field = nullptr;
+    }
+  }
   vector<Point> best_moves;
   int best_score = INT_MIN;
   Point move;
   for (move.x = -1; move.x <= 1; move.x++) {
     for (move.y = -1; move.y <= 1; move.y++) {
-      const int score = ScoreMove(sprite, game_state, move);
+      const int score = ScoreMove(sprite, game_state, field, move);
       if (score > best_score) {
         best_score = score;
         best_moves.clear();
@@ -56,57 +67,44 @@ const Point GetBestMove(const Sprite& sprite, const GameState& game_state) {
     }
   }
   ASSERT(best_moves.size() > 0);
-  return best_moves[rand() % best_moves.size()];
+  return best_moves[rng->Uniform(best_moves.size())];
 }
 
 }  // namespace
 
-Sprite::Sprite(const Point& s, int t) : square(s),  id(gIdCounter) {
-  gIdCounter += 1;
-  Polymorph(t);
-  if (IsPlayer()) {
-    energy = kEnergyNeededToMove;
-  } else {
-    energy = rand() % kEnergyNeededToMove;
-  }
-}
-
 bool Sprite::HasEnergyNeededToMove() const {
-  return energy >= kEnergyNeededToMove;
+  return store_->energies[index_] >= kEnergyNeededToMove;
 }
 
-bool Sprite::GainEnergy() {
-  energy += creature->stats.speed;
-  return energy >= kEnergyNeededToMove;
+int Sprite::GainEnergy() {
+  int& energy = store_->energies[index_];
+  if (energy >= kEnergyNeededToMove) {
+    return 1;
+  }
+  const int speed = store_->speeds[index_];
+  ASSERT(speed > 0);
+  const int visits = (kEnergyNeededToMove - energy + speed - 1)/speed;
+  energy += visits*speed;
+  return visits;
 }
 
 void Sprite::ConsumeEnergy() {
-  energy -= kEnergyNeededToMove;
+  store_->energies[index_] -= kEnergyNeededToMove;
 }
 
-Action* Sprite::GetAction(const GameState& game_state) const {
+Action Sprite::GetAction(const GameState& game_state, RNG* rng) const {
   ASSERT(!IsPlayer());
   if (AreAdjacent(*this, *game_state.player)) {
-    return new AttackAction(game_state.player);
+    return Action::Attack(game_state.player->Id());
   } else {
-    return new MoveAction(GetBestMove(*this, game_state));
+    const Point move = GetBestMove(*this, game_state, rng);
+    const Point square = this->square() + move;
+    if (game_state.map->IsSquareBlocked(square)) {
+      return Action::OpenDoor(square);
+    }
+    return Action::Move(move);
   }
 }
 
-void Sprite::Polymorph(int t) {
-  type = t;
-  creature = &kCreatures[t];
-  max_health = creature->stats.max_health;
-  cur_health = max_health;
-}
-
-bool Sprite::IsAlive() const {
-  return cur_health > 0;
-}
-
-bool Sprite::IsPlayer() const {
-  return type == mPlayer;
-}
-
 }  // namespace engine
 }  // namespace babel
@@ -6,6 +6,8 @@
 
 #include "base/creature.h"
 #include "base/point.h"
+#include "base/rng.h"
+#include "engine/SpriteStore.h"
 
 namespace babel {
 namespace engine {
@@ -13,38 +15,50 @@ namespace engine {
 class Action;
 class GameState;
 
-typedef uint32_t sid;
-
+// Sprite is a lightweight proxy for one row of a SpriteStore. Sprites are
+// created and owned by the store, through GameState::AddNPC.
 class Sprite {
  public:
-  Sprite(const Point& square, int type);
-
   // Methods needed by the game loop to run sprites at the correct speeds.
+  // GainEnergy gains the energy that the sprite gets from each visit of the
+  // round-robin loop until it has enough to move, and returns the number of
+  // visits needed (1 if the sprite already has the energy needed to move).
   bool HasEnergyNeededToMove() const;
-  bool GainEnergy();
+  int GainEnergy();
   void ConsumeEnergy();
 
   // Runs an NPC's AI logic and returns an action to take.
   // This method will crash if called on the player.
-  Action* GetAction(const GameState& game_state) const;
+  Action GetAction(const GameState& game_state, RNG* rng) const;
 
   // Turns the sprite into a creature of the given type and resets its stats.
-  void Polymorph(int type);
+  // A scheduled sprite may only be polymorphed on its own turn, since its
+  // speed changes. See Scheduler::AddSprite.
+  void Polymorph(int type) { store_->Polymorph(index_, type); }
 
-  sid Id() const { return id; };
-  bool IsAlive() const;
-  bool IsPlayer() const;
+  sid Id() const { return store_->ids[index_]; }
+  bool IsAlive() const { return cur_health() > 0; }
+  bool IsPlayer() const { return type() == mPlayer; }
 
-  int type;
-  const Creature* creature;
+  int type() const { return store_->types[index_]; }
+  const Creature* creature() const { return &kCreatures[type()]; }
+  int vision_radius() const { return store_->vision_radii[index_]; }
+  int speed() const { return store_->speeds[index_]; }
 
-  Point square;
-  int cur_health;
-  int max_health;
+  const Point& square() const { return store_->squares[index_]; }
+  int cur_health() const { return store_->cur_healths[index_]; }
+  int max_health() const { return store_->max_healths[index_]; }
+  void set_cur_health(int health) { store_->cur_healths[index_] = health; }
+  void set_max_health(int health) { store_->max_healths[index_] = health; }
 
  private:
-  sid id;
-  int energy;
+  Sprite(SpriteStore* store, int index) : store_(store), index_(index) {};
+
+  friend class GameState;
+  friend class SpriteStore;
+
+  SpriteStore* store_;
+  int index_;
 };
 
 }  // namespace engine
@@ -0,0 +1,75 @@
+#include "engine/SpriteStore.h"
+
+#include "base/creature.h"
+#include "base/debug.h"
+#include "engine/Sprite.h"
+
+namespace babel {
+namespace engine {
+
+SpriteStore::~SpriteStore() {
+  for (int i = 0; i < proxies_.size(); i++) {
+    delete proxies_[i];
+  }
+}
+
+Sprite* SpriteStore::Add(const Point& square, int type, int energy) {
+  const int index = proxies_.size();
+  Sprite* sprite = new Sprite(this, index);
+  ids.push_back(proxies_.Add(sprite));
+  ASSERT(proxies_.Index(ids.back()) == index);
+  squares.push_back(square);
+  energies.push_back(energy);
+  cur_healths.push_back(0);
+  max_healths.push_back(0);
+  types.push_back(0);
+  speeds.push_back(0);
+  vision_radii.push_back(0);
+  Polymorph(index, type);
+  return sprite;
+}
+
+void SpriteStore::Remove(sid id) {
+  const int index = proxies_.Index(id);
+  delete proxies_[index];
+  proxies_.Remove(id);
+
+  // Mirror the slot map, which moved its last value into the removed slot.
+  const int last = ids.size() - 1;
+  if (index != last) {
+    proxies_[index]->index_ = index;
+    ids[index] = ids[last];
+    squares[index] = squares[last];
+    energies[index] = energies[last];
+    cur_healths[index] = cur_healths[last];
+    max_healths[index] = max_healths[last];
+    types[index] = types[last];
+    speeds[index] = speeds[last];
+    vision_radii[index] = vision_radii[last];
+  }
+  ids.pop_back();
+  squares.pop_back();
+  energies.pop_back();
+  cur_healths.pop_back();
+  max_healths.pop_back();
+  types.pop_back();
+  speeds.pop_back();
+  vision_radii.pop_back();
+}
+
+Sprite* SpriteStore::Get(sid id) const {
+  Sprite* const* sprite = proxies_.Get(id);
+  return sprite == nullptr ? nullptr : *sprite;
+}
+
+void SpriteStore::Polymorph(int index, int type) {
+  const Creature& creature = kCreatures[type];
+  types[index] = type;
+  max_healths[index] = creature.stats.max_health;
+  cur_healths[index] = creature.stats.max_health;
+  speeds[index] = creature.stats.speed;
+  vision_radii[index] = creature.stats.vision_radius;
+}
+
+}  // namespace engine
+}  // namespace babel
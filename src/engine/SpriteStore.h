@@ -0,0 +1,77 @@
+// SpriteStore holds the state of all sprites in the game as a structure of
+// arrays: each component (square, energy, health, type, and the creature
+// stats that are read every turn) is a contiguous column indexed by the
+// sprite's dense index. Passes over all sprites, like culling sprites for a
+// View, can stream through just the columns they need.
+//
+// Each sprite also has a Sprite proxy, which refers to its row by index and
+// exposes the old per-object API. Proxies are owned by the store, and their
+// addresses are stable until the sprite is removed.
+//
+// Removing a sprite moves the last row into its place, so dense indices are
+// only stable until the next removal. Use sprite ids to refer to sprites.
+
+#ifndef __BABEL_ENGINE_SPRITE_STORE_H__
+#define __BABEL_ENGINE_SPRITE_STORE_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/point.h"
+#include "base/slot_map.h"
+
+namespace babel {
+namespace engine {
+
+class Sprite;
+
+// Sprite ids are generational handles into the store's slot map. They are
+// assigned when a sprite is added to the game and never reused (SlotMap
+// retires a slot rather than wrap its generation), so a stale id can be
+// detected with GameState::GetSprite. 0 is never an id.
+typedef uint32_t sid;
+static const sid kInvalidSid = 0;
+
+static const int kEnergyNeededToMove = 240;
+
+class SpriteStore {
+ public:
+  ~SpriteStore();
+
+  // Add returns the new sprite's proxy. Remove deletes the proxy, so the
+  // sprite's id becomes stale. Crashes if the id is already stale.
+  Sprite* Add(const Point& square, int type, int energy);
+  void Remove(sid id);
+
+  // Returns nullptr if the id is stale.
+  Sprite* Get(sid id) const;
+
+  // Returns the proxy for the sprite at the given dense index.
+  Sprite* At(int index) const { return proxies_[index]; }
+
+  int size() const { return proxies_.size(); }
+
+  // The component columns. Callers may modify the elements of the columns
+  // (GameState does, to keep its indices in sync), but never resize them.
+  std::vector<sid> ids;
+  std::vector<Point> squares;
+  std::vector<int> energies;
+  std::vector<int> cur_healths;
+  std::vector<int> max_healths;
+  std::vector<int> types;
+  std::vector<int> speeds;
+  std::vector<int> vision_radii;
+
+ private:
+  // Resets the health and creature stats of the sprite at the given index.
+  void Polymorph(int index, int type);
+
+  friend class Sprite;
+
+  SlotMap<Sprite*> proxies_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_SPRITE_STORE_H__
@@ -0,0 +1,124 @@
+#include "engine/SpriteVision.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "base/debug.h"
+#include "engine/Sprite.h"
+
+using std::vector;
+
+namespace babel {
+namespace engine {
+
+namespace {
+
+// Handing a slice of a batch to the thread pool costs about as much as
+// computing this many fields of vision, so smaller batches are not split.
+static const int kMinBatchPerThread = 32;
+
+}  // namespace
+
+SpriteVision::SpriteVision(const BitGrid& opacity, ThreadPool* pool)
+    : opacity_(opacity), pool_(pool) {}
+
+void SpriteVision::MarkStale(sid id) {
+  Entry& entry = entries_[id];
+  if (entry.stale_index < 0) {
+    entry.stale_index = stale_.size();
+    stale_.push_back(id);
+  }
+}
+
+void SpriteVision::Remove(sid id) {
+  const auto& it = entries_.find(id);
+  if (it == entries_.end()) {
+    return;
+  }
+  // Move the last stale id into this entry's slot.
+  const int index = it->second.stale_index;
+  if (index >= 0) {
+    stale_[index] = stale_.back();
+    entries_[stale_[index]].stale_index = index;
+    stale_.pop_back();
+  }
+  entries_.erase(it);
+}
+
+void SpriteVision::UpdateTile(const Point& square, bool was_blocked) {
+  for (auto& pair : entries_) {
+    if (pair.second.stale_index < 0) {
+      pair.second.vision->UpdateSquare(square, was_blocked);
+    }
+  }
+}
+
+bool SpriteVision::IsCurrent(const SpriteStore& sprites, sid id) const {
+  const auto& it = entries_.find(id);
+  const Sprite* sprite = sprites.Get(id);
+  return (it != entries_.end() && it->second.stale_index < 0 &&
+          sprite != nullptr &&
+          it->second.source == sprite->square() &&
+          it->second.radius == sprite->vision_radius());
+}
+
+int SpriteVision::Update(const SpriteStore& sprites) {
+  return Update(sprites, nullptr);
+}
+
+int SpriteVision::UpdateNear(const SpriteStore& sprites, const Point& target) {
+  return Update(sprites, &target);
+}
+
+int SpriteVision::Update(const SpriteStore& sprites, const Point* target) {
+  vector<Entry*> batch;
+  vector<sid> still_stale;
+  for (sid id : stale_) {
+    Entry& entry = entries_[id];
+    const Sprite* sprite = sprites.Get(id);
+    ASSERT(sprite != nullptr);
+    const int radius = sprite->vision_radius();
+    if (target != nullptr) {
+      const Point diff = *target - sprite->square();
+      if (abs(diff.x) > radius || abs(diff.y) > radius) {
+        entry.stale_index = still_stale.size();
+        still_stale.push_back(id);
+        continue;
+      }
+    }
+    entry.source = sprite->square();
+    entry.radius = radius;
+    entry.stale_index = -1;
+    batch.push_back(&entry);
+  }
+  stale_.swap(still_stale);
+
+  // Each task computes a contiguous slice of the batch. Entries are not
+  // shared between slices, and each thread has its own FOV scratch space.
+  const int size = batch.size();
+  const int num_slices = (pool_ == nullptr ? 1 : std::max(std::min(
+      pool_->GetNumThreads(), size/kMinBatchPerThread), 1));
+  const auto compute = [this, &batch, size, num_slices](int slice) {
+    const int end = size*(slice + 1)/num_slices;
+    for (int i = size*slice/num_slices; i < end; i++) {
+      Entry* entry = batch[i];
+      entry->vision.reset(
+          new FieldOfVision(opacity_, entry->source, entry->radius));
+    }
+  };
+  if (num_slices > 1) {
+    pool_->Run(num_slices, compute);
+  } else {
+    compute(0);
+  }
+  return size;
+}
+
+const FieldOfVision& SpriteVision::Get(sid id) const {
+  const auto& it = entries_.find(id);
+  ASSERT(it != entries_.end() && it->second.stale_index < 0);
+  return *it->second.vision;
+}
+
+}  // namespace engine
+}  // namespace babel
@@ -0,0 +1,83 @@
+// SpriteVision keeps a field of vision for each NPC, so that AI can ask what
+// a sprite sees from its own square with its own vision radius.
+//
+// Fields of vision are computed lazily, in batches. When a sprite moves, its
+// field of vision is marked stale but not recomputed. When the owner needs to
+// know who can see a square, UpdateNear recomputes the stale fields of vision
+// of all sprites close enough to see it in one pass, which is spread across a
+// thread pool if the batch is large. Sprites that have not moved keep their
+// fields of vision: tile changes update them in place, and only if the tile
+// could affect them.
+//
+// All fields of vision read the same packed opacity grid, which the owner
+// must keep in sync with the map, and must call UpdateTile after changing.
+
+#ifndef __BABEL_ENGINE_SPRITE_VISION_H__
+#define __BABEL_ENGINE_SPRITE_VISION_H__
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "base/bit_grid.h"
+#include "base/point.h"
+#include "base/thread_pool.h"
+#include "engine/FieldOfVision.h"
+#include "engine/SpriteStore.h"
+
+namespace babel {
+namespace engine {
+
+class SpriteVision {
+ public:
+  // Does NOT take ownership of the opacity grid or the thread pool, which
+  // must outlive this index. If the pool is null, batches are computed on the
+  // calling thread.
+  SpriteVision(const BitGrid& opacity, ThreadPool* pool);
+
+  // MarkStale should be called when a sprite is added or moved, and Remove
+  // when it is removed. Both are O(1), and Remove forgets the sprite entirely.
+  void MarkStale(sid id);
+  void Remove(sid id);
+
+  // Updates the fields of vision that contain the square after its tile
+  // changed. The opacity grid must already reflect the change.
+  void UpdateTile(const Point& square, bool was_blocked);
+
+  // Returns true if the sprite's field of vision is up to date for its
+  // current square and vision radius.
+  bool IsCurrent(const SpriteStore& sprites, sid id) const;
+
+  // Recomputes every stale field of vision. Returns the number recomputed.
+  int Update(const SpriteStore& sprites);
+
+  // Recomputes the stale fields of vision of the sprites that are within
+  // their vision radius of the target in x and y. Returns the number
+  // recomputed. Other stale fields of vision stay stale.
+  int UpdateNear(const SpriteStore& sprites, const Point& target);
+
+  // The sprite's field of vision must be current.
+  const FieldOfVision& Get(sid id) const;
+
+ private:
+  struct Entry {
+    Point source;
+    int radius;
+    // The entry's index in stale_, or -1 if it is not stale.
+    int stale_index = -1;
+    std::unique_ptr<FieldOfVision> vision;
+  };
+
+  // Recomputes all stale fields of vision if target is null.
+  int Update(const SpriteStore& sprites, const Point* target);
+
+  const BitGrid& opacity_;
+  ThreadPool* pool_;
+  std::unordered_map<sid,Entry> entries_;
+  std::vector<sid> stale_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_SPRITE_VISION_H__
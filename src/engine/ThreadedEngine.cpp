@@ -0,0 +1,108 @@
+#include "engine/ThreadedEngine.h"
+
+#ifdef BABEL_THREADED_ENGINE
+
+#include <chrono>
+
+#include "base/debug.h"
+
+using std::unique_ptr;
+
+namespace babel {
+namespace engine {
+
+namespace {
+
+static const int kInputCapacity = 256;
+
+// The worker checks for new inputs and for shutdown between update slices,
+// and it publishes a view after each slice that changes something.
+static const int kUpdateBudgetUs = 4000;
+
+static const std::chrono::milliseconds kIdleSleep(1);
+
+}  // namespace
+
+ThreadedEngine::ThreadedEngine(uint32_t seed, const Point& view_size)
+    : view_size_(view_size), engine_(seed), inputs_(kInputCapacity) {
+  views_.Back().reset(engine_.GetView(view_size_));
+  views_.Publish();
+}
+
+ThreadedEngine::~ThreadedEngine() {
+  Stop();
+}
+
+void ThreadedEngine::AddEventHandler(EventHandler* handler) {
+  ASSERT(!thread_.joinable());
+  engine_.AddEventHandler(handler);
+}
+
+void ThreadedEngine::StartJournal() {
+  ASSERT(!thread_.joinable());
+  engine_.StartJournal();
+}
+
+void ThreadedEngine::Start() {
+  ASSERT(!thread_.joinable());
+  thread_ = std::thread(&ThreadedEngine::Run, this);
+}
+
+void ThreadedEngine::Stop() {
+  stopping_.store(true);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool ThreadedEngine::AddInput(const Action& input) {
+  ASSERT(input.type != ActionType::NONE);
+  return inputs_.TryPush(input);
+}
+
+bool ThreadedEngine::AddInput(Action* input) {
+  ASSERT(input != nullptr);
+  unique_ptr<Action> owned(input);
+  return AddInput(*owned);
+}
+
+const View* ThreadedEngine::GetView() {
+  views_.Update();
+  return views_.Front().get();
+}
+
+const Journal* ThreadedEngine::GetJournal() const {
+  ASSERT(!thread_.joinable());
+  return engine_.GetJournal();
+}
+
+void ThreadedEngine::Run() {
+  Action input;
+  UpdateResult result;
+  while (true) {
+    // Engine::AddInput drops an input that arrives while the player already
+    // has one waiting, so inputs are passed on only between updates. The
+    // stop flag is read first, so that every input added before Stop is seen.
+    if (!result.pending) {
+      const bool stopping = stopping_.load(std::memory_order_acquire);
+      if (inputs_.TryPop(&input)) {
+        engine_.AddInput(input);
+      } else if (stopping) {
+        break;
+      }
+    }
+    result = engine_.Update(kUpdateBudgetUs, 0);
+    if (result.changed) {
+      views_.Back().reset(engine_.GetView(view_size_));
+      views_.Publish();
+    }
+    if (!result.pending && inputs_.IsEmpty()) {
+      std::this_thread::sleep_for(kIdleSleep);
+    }
+  }
+}
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // BABEL_THREADED_ENGINE
@@ -0,0 +1,96 @@
+// ThreadedEngine runs an Engine on its own worker thread. The UI thread
+// passes inputs to the worker through a lock-free ring, and the worker
+// publishes a View after every update that changes something into a triple
+// buffer, so the UI thread never blocks on the engine and never sees a
+// partly built view.
+//
+// The worker hands the engine one input at a time, and only once the update
+// for the previous input has finished, so the game plays exactly as it would
+// if each input were passed to Engine::AddInput and followed by an Update.
+//
+// AddInput and GetView must each be called from a single thread (which may
+// be the same thread). Event handlers are called on the worker thread.
+//
+// The threaded engine is only available natively, in which case
+// BABEL_THREADED_ENGINE is defined. In the browser, an update can launch a
+// dialog, and dialogs call into the page's DialogManager, which only exists
+// on the main thread.
+
+#ifndef __BABEL_ENGINE_THREADED_ENGINE_H__
+#define __BABEL_ENGINE_THREADED_ENGINE_H__
+
+#ifndef EMSCRIPTEN
+#define BABEL_THREADED_ENGINE
+#endif
+
+#ifdef BABEL_THREADED_ENGINE
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "base/point.h"
+#include "base/spsc_ring.h"
+#include "base/triple_buffer.h"
+#include "engine/Action.h"
+#include "engine/Engine.h"
+#include "engine/EventHandler.h"
+#include "engine/Journal.h"
+#include "engine/View.h"
+
+namespace babel {
+namespace engine {
+
+class ThreadedEngine {
+ public:
+  // Views are built with the given size. The worker is not started until
+  // Start is called, so event handlers can be added first.
+  ThreadedEngine(uint32_t seed, const Point& view_size);
+  ~ThreadedEngine();
+
+  // Does NOT take ownership of the input EventHandler. Must be called
+  // before Start.
+  void AddEventHandler(EventHandler* handler);
+
+  // Journals the inputs that the engine consumes. See Engine::StartJournal.
+  // Must be called before Start.
+  void StartJournal();
+
+  void Start();
+
+  // Finishes the inputs that have already been added, then stops the worker.
+  // The destructor calls Stop if it has not been called. AddInput must not be
+  // called after Stop, but GetView still returns the last view.
+  void Stop();
+
+  // Returns false, and drops the input, if the input ring is full.
+  bool AddInput(const Action& input);
+
+  // Takes ownership of the input Action. Used by the Javascript bindings.
+  bool AddInput(Action* input);
+
+  // Returns the most recent view that the worker has published. The view is
+  // owned by the engine and stays valid until the next call to GetView.
+  const View* GetView();
+
+  // Returns nullptr if the engine is not journaling. Must not be called while
+  // the worker is running.
+  const Journal* GetJournal() const;
+
+ private:
+  void Run();
+
+  const Point view_size_;
+  Engine engine_;
+  SpscRing<Action> inputs_;
+  TripleBuffer<std::unique_ptr<View>> views_;
+  std::atomic<bool> stopping_{false};
+  std::thread thread_;
+};
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // BABEL_THREADED_ENGINE
+
+#endif  // __BABEL_ENGINE_THREADED_ENGINE_H__
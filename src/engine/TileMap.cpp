@@ -6,8 +6,8 @@ using std::vector;
 namespace babel {
 namespace engine {
 
-Point TileMap::Room::GetRandomSquare() const {
-  return squares[rand() % squares.size()];
+Point TileMap::Room::GetRandomSquare(RNG* rng) const {
+  return squares[rng->Uniform(squares.size())];
 }
 
 Graphic TileMap::GetGraphic(const Point& square) const {
@@ -37,6 +37,9 @@ void TileMap::SetTile(const Point& square, Tile tile) {
     if (tiles_[index] != tile) {
       graphics_[index] = tileset_->GetGraphicForTile(tile);
       tiles_[index] = tile;
+      if (jump_points_ != nullptr) {
+        jump_points_->UpdateTile(square, tile != Tile::FREE);
+      }
     }
   }
 }
@@ -58,5 +61,24 @@ void TileMap::PackTiles(const vector<vector<Tile>>& tiles) {
   }
 }
 
+const JumpPointTable& TileMap::GetJumpPointTable() const {
+  if (jump_points_ == nullptr) {
+    jump_points_.reset(new JumpPointTable(GetBlockedSquares()));
+  }
+  return *jump_points_;
+}
+
+BitGrid TileMap::GetBlockedSquares() const {
+  BitGrid blocked(size_);
+  for (int x = 0; x < size_.x; x++) {
+    for (int y = 0; y < size_.y; y++) {
+      if (IsSquareBlocked(Point(x, y))) {
+        blocked.Set(Point(x, y));
+      }
+    }
+  }
+  return blocked;
+}
+
 }  // namespace engine
 } // namespace babel
@@ -5,6 +5,8 @@
 #include <vector>
 
 #include "base/point.h"
+#include "base/rng.h"
+#include "engine/JumpPointTable.h"
 #include "engine/tileset.h"
 
 namespace babel {
@@ -13,7 +15,7 @@ namespace engine {
 class TileMap {
  public:
   struct Room {
-    Point GetRandomSquare() const;
+    Point GetRandomSquare(RNG* rng) const;
     std::vector<Point> squares;
   };
 
@@ -25,6 +27,10 @@ class TileMap {
   const Point& GetSize() const { return size_; };
   const Point& GetStartingSquare() const { return starting_square_; }
 
+  // Returns the jump distances for Pathfinder's jump point search. The table
+  // is built on the first call, and SetTile keeps it up to date after that.
+  const JumpPointTable& GetJumpPointTable() const;
+
   void SetTile(const Point& square, Tile tile);
 
  protected:
@@ -44,6 +50,12 @@ class TileMap {
   std::unique_ptr<Tileset> tileset_;
   Point starting_square_;
   std::vector<Room> rooms_;
+  // Null until the first GetJumpPointTable call.
+  mutable std::unique_ptr<JumpPointTable> jump_points_;
+
+ private:
+  // Returns a bit grid with a set bit for each blocked square.
+  BitGrid GetBlockedSquares() const;
 };
 
 } // namespace engine
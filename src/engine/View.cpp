@@ -13,36 +13,39 @@ namespace engine {
 
 View::View(const Point& s, const GameState& game_state)
     : size(s), offset(0, 0), tiles(size.x, vector<TileView>(size.y)) {
-  const int vision = game_state.player->creature->stats.vision_radius;
   for (int x = 0; x < size.x; x++) {
     for (int y = 0; y < size.y; y++) {
       Point square = Point(x, y) + offset;
       if (game_state.IsSquareSeen(square)) {
         tiles[x][y].graphic = game_state.map->GetGraphic(square);
-        tiles[x][y].visible =
-            game_state.player_vision->IsSquareVisible(square, vision);
+        tiles[x][y].visible = game_state.CanPlayerSee(square);
+        tiles[x][y].light = (tiles[x][y].visible ?
+                             game_state.lights->GetLight(square) : 0);
       } else {
         tiles[x][y].graphic = -1;
+        tiles[x][y].light = 0;
       }
     }
   }
-  for (const Sprite* sprite : game_state.sprites) {
-    if (!sprite->IsAlive()) {
+  // Cull sprites by streaming through the sprite store's columns.
+  const SpriteStore& store = game_state.sprites;
+  for (int i = 0; i < store.size(); i++) {
+    if (store.cur_healths[i] <= 0) {
       continue;
     }
-    Point square = sprite->square - offset;
+    Point square = store.squares[i] - offset;
     if (0 <= square.x && square.x < size.x &&
         0 <= square.y && square.y < size.y &&
-        game_state.player_vision->IsSquareVisible(sprite->square, vision)) {
-      const auto& appearance = sprite->creature->appearance;
-      sprites.push_back(SpriteView{sprite->Id(), appearance.graphic, square});
+        game_state.CanPlayerSee(store.squares[i])) {
+      const auto& appearance = kCreatures[store.types[i]].appearance;
+      sprites.push_back(SpriteView{store.ids[i], appearance.graphic, square});
     }
   }
   if (game_state.log.IsFresh()) {
     log = game_state.log.GetLastLines(1);
   }
-  status.cur_health = game_state.player->cur_health;
-  status.max_health = game_state.player->max_health;
+  status.cur_health = game_state.player->cur_health();
+  status.max_health = game_state.player->max_health();
 }
 
 }  // namespace engine 
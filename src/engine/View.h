@@ -16,6 +16,8 @@ struct TileView {
   // graphic will be -1 if the tile is unknown to the player.
   Graphic graphic;
   bool visible;
+  // The tile's light level if it is visible, and 0 otherwise.
+  int light;
 };
 
 struct SpriteView {
@@ -0,0 +1,100 @@
+// Vision masks give the shape of a creature's field of vision: a disc around
+// its square whose radius is the creature's Stats::vision_radius. A mask has
+// 2*radius + 1 rows, one for each dy from -radius to radius, and bit
+// dx + radius of a row is set if (dx, dy) is strictly within the radius.
+//
+// Masks are generated at compile time, for every radius a 64-bit row can
+// hold, and never change, so they can be shared between threads without any
+// locking. FieldOfVision tests the mask as the scan visits each square.
+// Larger radii, which only very large maps use, have no mask, and fall back
+// to testing the distance directly.
+
+#ifndef __BABEL_ENGINE_VISION_MASK_H__
+#define __BABEL_ENGINE_VISION_MASK_H__
+
+#include <stdint.h>
+
+#include "base/debug.h"
+#include "base/point.h"
+
+namespace babel {
+namespace engine {
+
+static const int kMaxVisionMaskRadius = 31;
+
+namespace internal {
+
+template<int... I> struct IntList {};
+template<int N, int... I>
+struct MakeIntList : MakeIntList<N - 1, N - 1, I...> {};
+template<int... I>
+struct MakeIntList<0, I...> { typedef IntList<I...> type; };
+
+// Returns the largest dx <= max_dx in the disc's row dy, or -1 if none are.
+constexpr int GetHalfWidth(int radius, int dy, int max_dx) {
+  return (max_dx < 0 || max_dx*max_dx + dy*dy < radius*radius ?
+          max_dx : GetHalfWidth(radius, dy, max_dx - 1));
+}
+
+constexpr uint64_t GetRowFromHalfWidth(int radius, int half_width) {
+  return (half_width < 0 ? 0 :
+          ((1ULL << (2*half_width + 1)) - 1) << (radius - half_width));
+}
+
+constexpr uint64_t GetRow(int radius, int dy) {
+  return GetRowFromHalfWidth(radius, GetHalfWidth(radius, dy, radius));
+}
+
+template<int Radius, typename Rows = typename MakeIntList<2*Radius + 1>::type>
+struct DiscMask;
+
+template<int Radius, int... Row>
+struct DiscMask<Radius, IntList<Row...>> {
+  static constexpr uint64_t kRows[] = {GetRow(Radius, Row - Radius)...};
+};
+
+template<int Radius, int... Row>
+constexpr uint64_t DiscMask<Radius, IntList<Row...>>::kRows[];
+
+template<typename Radii>
+struct DiscMaskTable;
+
+template<int... Radius>
+struct DiscMaskTable<IntList<Radius...>> {
+  static constexpr const uint64_t* kMasks[] = {DiscMask<Radius>::kRows...};
+};
+
+template<int... Radius>
+constexpr const uint64_t* DiscMaskTable<IntList<Radius...>>::kMasks[];
+
+typedef DiscMaskTable<MakeIntList<kMaxVisionMaskRadius + 1>::type>
+    VisionMasks;
+
+static_assert(DiscMask<2>::kRows[0] == 0, "Mask rim is exclusive.");
+static_assert(DiscMask<2>::kRows[1] == 0x0e, "Mask rows are centered.");
+static_assert(DiscMask<2>::kRows[2] == 0x0e, "Mask rim is exclusive.");
+
+}  // namespace internal
+
+// Returns null if the radius is too large to have a mask.
+inline const uint64_t* GetVisionMask(int radius) {
+  ASSERT(radius >= 0);
+  return (radius <= kMaxVisionMaskRadius ?
+          internal::VisionMasks::kMasks[radius] : nullptr);
+}
+
+// Equivalent to diff.length() < radius.
+inline bool IsInVisionMask(int radius, const Point& diff) {
+  if (diff.x < -radius || diff.x > radius ||
+      diff.y < -radius || diff.y > radius) {
+    return false;
+  } else if (radius > kMaxVisionMaskRadius) {
+    return diff.x*diff.x + diff.y*diff.y < radius*radius;
+  }
+  return (GetVisionMask(radius)[diff.y + radius] >> (diff.x + radius)) & 1;
+}
+
+}  // namespace engine
+}  // namespace babel
+
+#endif  // __BABEL_ENGINE_VISION_MASK_H__
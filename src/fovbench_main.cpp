@@ -0,0 +1,205 @@
+// Benchmarks the field-of-vision backends against each other. For each map,
+// it computes fields of vision from the same random free squares with every
+// backend, and reports the time per call and how many squares differ from
+// the permissive result: extra squares that permissive FOV hides, and missing
+// squares that it shows. Permissive FOV is also run with its quadrants spread
+// across a thread pool, which only kicks in for large radii.
+//
+// Usage: fovbench [radius] [calls] [world_file...]
+//
+// The maps are generated 48x24 RoomAndCorridorMap levels, plus the given
+// 1024x1024 world files (by default, meteor/public/*World.dat). World files
+// hold one tile variant byte per square and no walls, so squares with variant
+// 0 are treated as blocked, which scatters obstacles over about a quarter of
+// the map.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/bit_grid.h"
+#include "base/debug.h"
+#include "base/rng.h"
+#include "base/thread_pool.h"
+#include "base/timing.h"
+#include "engine/FieldOfVision.h"
+#include "gen/RoomAndCorridorMap.h"
+
+using babel::BitGrid;
+using babel::Point;
+using babel::RNG;
+using babel::engine::FieldOfVision;
+using babel::engine::FovAlgorithm;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+static const int kNumLevels = 20;
+static const int kWorldSize = 1024;
+static const int kNumThreads = 4;
+
+struct Backend {
+  FovAlgorithm algorithm;
+  bool parallel;
+  const char* name;
+};
+
+const Backend kBackends[] = {
+    {babel::engine::PERMISSIVE, false, "permissive"},
+    {babel::engine::PERMISSIVE, true, "permissive, thread pool"},
+    {babel::engine::RECURSIVE_SHADOWCASTING, false, "recursive shadowcasting"},
+    {babel::engine::SYMMETRIC_SHADOWCASTING, false, "symmetric shadowcasting"}};
+
+struct Map {
+  string name;
+  BitGrid opacity;
+};
+
+Map GenerateLevel(uint32_t seed) {
+  RNG rng(seed);
+  babel::gen::RoomAndCorridorMap level(Point(48, 24), &rng);
+  Map map{"level " + std::to_string(seed), BitGrid(level.GetSize())};
+  for (int x = 0; x < level.GetSize().x; x++) {
+    for (int y = 0; y < level.GetSize().y; y++) {
+      if (level.IsSquareBlocked(Point(x, y))) {
+        map.opacity.Set(Point(x, y));
+      }
+    }
+  }
+  return map;
+}
+
+bool LoadWorld(const string& filename, Map* map) {
+  std::ifstream file(filename, std::ios::binary);
+  std::stringstream stream;
+  stream << file.rdbuf();
+  const string bytes = stream.str();
+  if (!file || bytes.size() != kWorldSize*kWorldSize) {
+    return false;
+  }
+  map->name = filename;
+  map->opacity = BitGrid(Point(kWorldSize, kWorldSize));
+  for (int y = 0; y < kWorldSize; y++) {
+    for (int x = 0; x < kWorldSize; x++) {
+      if (bytes[y*kWorldSize + x] == 0) {
+        map->opacity.Set(Point(x, y));
+      }
+    }
+  }
+  return true;
+}
+
+vector<Point> GetSources(const BitGrid& opacity, int num_sources) {
+  RNG rng(num_sources);
+  vector<Point> sources;
+  while ((int)sources.size() < num_sources) {
+    const Point source(rng.Uniform(opacity.GetSize().x),
+                       rng.Uniform(opacity.GetSize().y));
+    if (!opacity.Get(source)) {
+      sources.push_back(source);
+    }
+  }
+  return sources;
+}
+
+struct Result {
+  babel::tick elapsed = 0;
+  // Keeps the timed calls from being optimized away.
+  long long sink = 0;
+  long long extra = 0;
+  long long missing = 0;
+};
+
+// Adds the results for each backend on the map to results.
+void Benchmark(const Map& map, int radius, int calls, babel::ThreadPool* pool,
+               vector<Result>* results) {
+  const vector<Point> sources = GetSources(map.opacity, calls);
+  vector<unique_ptr<FieldOfVision>> expected;
+  for (int i = 0; i < (int)results->size(); i++) {
+    const Backend& backend = kBackends[i];
+    babel::ThreadPool* backend_pool = (backend.parallel ? pool : nullptr);
+    Result& result = (*results)[i];
+    const babel::tick start = babel::GetCurrentTick();
+    for (const Point& source : sources) {
+      FieldOfVision vision(
+          map.opacity, source, radius, backend.algorithm, backend_pool);
+      result.sink += vision.IsSquareVisible(source);
+    }
+    result.elapsed += babel::GetCurrentTick() - start;
+
+    for (int j = 0; j < (int)sources.size(); j++) {
+      unique_ptr<FieldOfVision> vision(new FieldOfVision(
+          map.opacity, sources[j], radius, backend.algorithm, backend_pool));
+      if (i == 0) {
+        expected.push_back(std::move(vision));
+        continue;
+      }
+      for (int x = -radius; x <= radius; x++) {
+        for (int y = -radius; y <= radius; y++) {
+          const Point square = sources[j] + Point(x, y);
+          const bool actual = vision->IsSquareVisible(square);
+          if (actual != expected[j]->IsSquareVisible(square)) {
+            (actual ? result.extra : result.missing) += 1;
+          }
+        }
+      }
+    }
+  }
+}
+
+void PrintResults(const string& title, int calls,
+                  const vector<Result>& results) {
+  printf("%s (%d calls)\n", title.c_str(), calls);
+  for (int i = 0; i < (int)results.size(); i++) {
+    const Result& result = results[i];
+    printf("  %-24s %8.2fus/call  %6.2f extra  %6.2f missing squares/call\n",
+           kBackends[i].name, 1.0*result.elapsed/calls,
+           1.0*result.extra/calls, 1.0*result.missing/calls);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+  const int radius = argc > 1 ? atoi(argv[1]) : 9;
+  const int calls = argc > 2 ? atoi(argv[2]) : 10000;
+  vector<string> worlds;
+  for (int i = 3; i < argc; i++) {
+    worlds.push_back(argv[i]);
+  }
+  if (argc <= 3) {
+    worlds = {"meteor/public/grassWorld.dat", "meteor/public/rockWorld.dat"};
+  }
+  if (radius < 0 || calls <= 0) {
+    fprintf(stderr, "Usage: %s [radius] [calls] [world_file...]\n", argv[0]);
+    return 1;
+  }
+  const int num_backends = sizeof(kBackends)/sizeof(kBackends[0]);
+  babel::ThreadPool pool(kNumThreads);
+
+  vector<Result> results(num_backends);
+  for (int i = 0; i < kNumLevels; i++) {
+    Benchmark(GenerateLevel(i), radius, calls/kNumLevels, &pool, &results);
+  }
+  PrintResults("RoomAndCorridorMap levels", kNumLevels*(calls/kNumLevels),
+               results);
+
+  for (const string& filename : worlds) {
+    Map map;
+    if (!LoadWorld(filename, &map)) {
+      fprintf(stderr, "Failed to load %s\n", filename.c_str());
+      return 1;
+    }
+    vector<Result> results(num_backends);
+    Benchmark(map, radius, calls, &pool, &results);
+    PrintResults(map.name, calls, results);
+  }
+  return 0;
+}
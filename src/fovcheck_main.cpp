@@ -0,0 +1,145 @@
+// Checks that PermissiveFov visits exactly the same squares as the
+// permissive-fov library that it was ported from. For each random map, it
+// computes fields of vision from random sources, some of them off the map,
+// at every radius from 0 to kMaxRadius with both, and compares how many times
+// each square was visited. The port must visit each square at most once.
+//
+// Usage: fovcheck [maps]
+//
+// Prints the number of scans and visited squares, and each mismatch, and
+// exits with a non-zero status if there were any.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "base/bit_grid.h"
+#include "base/debug.h"
+#include "base/rng.h"
+#include "engine/PermissiveFov.h"
+#include "permissive-fov.cc"
+#include "permissive-fov-cpp.h"
+
+using babel::BitGrid;
+using babel::Point;
+using babel::RNG;
+using babel::engine::gPermissiveFov;
+using std::vector;
+
+namespace {
+
+static const int kMaxRadius = 32;
+static const int kSourcesPerMap = 4;
+static const int kMaxMapSize = 64;
+static const int kMaxWallPercent = 60;
+
+// Counts the visits to each square within radius of the source. Visits
+// outside that box are counted together, since neither scan should make any.
+class Visits {
+ public:
+  Visits(const BitGrid& opacity, const Point& source, int radius)
+      : opacity_(opacity), source_(source), radius_(radius),
+        counts_((2*radius + 1)*(2*radius + 1), 0) {}
+
+  bool operator==(const Visits& other) const {
+    return counts_ == other.counts_ && outside_ == other.outside_;
+  }
+  bool operator!=(const Visits& other) const { return !(*this == other); }
+
+  int GetNumVisited() const {
+    int result = outside_;
+    for (const int count : counts_) {
+      result += count;
+    }
+    return result;
+  }
+
+  bool HasRepeatedVisits() const {
+    for (const int count : counts_) {
+      if (count > 1) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Interface methods for PermissiveFov.
+  bool IsBlocked(const Point& square) const {
+    return !opacity_.InBounds(square) || opacity_.Get(square);
+  }
+  void Visit(const Point& square) {
+    const Point offset = square - source_;
+    if (abs(offset.x) > radius_ || abs(offset.y) > radius_) {
+      outside_ += 1;
+      return;
+    }
+    const int side = 2*radius_ + 1;
+    counts_[(offset.x + radius_)*side + offset.y + radius_] += 1;
+  }
+
+  // Interface methods for the permissive-fov library.
+  bool isBlocked(short x, short y) const { return IsBlocked(Point(x, y)); }
+  void visit(short x, short y) { Visit(Point(x, y)); }
+
+ private:
+  const BitGrid& opacity_;
+  const Point source_;
+  const int radius_;
+  vector<int> counts_;
+  int outside_ = 0;
+};
+
+BitGrid GenerateMap(RNG* rng) {
+  const Point size(rng->Uniform(kMaxMapSize) + 1,
+                   rng->Uniform(kMaxMapSize) + 1);
+  const int wall_percent = rng->Uniform(kMaxWallPercent);
+  BitGrid opacity(size);
+  for (int x = 0; x < size.x; x++) {
+    for (int y = 0; y < size.y; y++) {
+      if (rng->Uniform(100) < wall_percent) {
+        opacity.Set(Point(x, y));
+      }
+    }
+  }
+  return opacity;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+  const int maps = argc > 1 ? atoi(argv[1]) : 1000;
+  if (maps <= 0) {
+    fprintf(stderr, "Usage: %s [maps]\n", argv[0]);
+    return 1;
+  }
+
+  RNG rng(maps);
+  long long scans = 0;
+  long long squares = 0;
+  int mismatches = 0;
+  for (int i = 0; i < maps; i++) {
+    const BitGrid opacity = GenerateMap(&rng);
+    const Point& size = opacity.GetSize();
+    for (int j = 0; j < kSourcesPerMap; j++) {
+      const Point source(rng.Uniform(size.x + 4) - 2,
+                         rng.Uniform(size.y + 4) - 2);
+      for (int radius = 0; radius <= kMaxRadius; radius++) {
+        Visits expected(opacity, source, radius);
+        permissive::squareFov<Visits>(source.x, source.y, radius, expected);
+        Visits actual(opacity, source, radius);
+        gPermissiveFov.Compute(source, radius, &actual);
+        scans += 1;
+        squares += actual.GetNumVisited();
+        if (actual != expected || actual.HasRepeatedVisits()) {
+          printf("Mismatch on map %d (%dx%d) from (%d, %d) at radius %d\n",
+                 i, size.x, size.y, source.x, source.y, radius);
+          mismatches += 1;
+        }
+      }
+    }
+  }
+  printf("%lld scans, %lld squares visited, %d mismatches\n",
+         scans, squares, mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
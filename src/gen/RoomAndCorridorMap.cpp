@@ -25,9 +25,13 @@ namespace {
 
 class DefaultTileset : public Tileset {
  public:
+  // The tileset draws variant graphics from its own generator, so that tiles
+  // set during the game do not need access to the game's RNG.
+  DefaultTileset(uint32_t seed) : rng_(seed) {}
+
   Graphic GetGraphicForTile(Tile tile) const override {
     if (tile == Tile::FREE) {
-      return rand() % 4;
+      return rng_.Uniform(4);
     } else if (tile == Tile::WALL) {
       return 4;
     } else if (tile == Tile::DOOR) {
@@ -37,19 +41,24 @@ class DefaultTileset : public Tileset {
     }
     return 5;
   }
+
+ private:
+  mutable RNG rng_;
 };
 
 }  // namespace
 
-RoomAndCorridorMap::RoomAndCorridorMap(const Point& size, bool verbose) {
-  while (!TryBuildMap(size, verbose)) {}
+RoomAndCorridorMap::RoomAndCorridorMap(
+    const Point& size, RNG* rng, bool verbose) {
+  while (!TryBuildMap(size, rng, verbose)) {}
 }
 
-bool RoomAndCorridorMap::TryBuildMap(const Point& size, bool verbose) {
+bool RoomAndCorridorMap::TryBuildMap(
+    const Point& size, RNG* rng, bool verbose) {
   size_ = size;
-  tileset_.reset(new DefaultTileset());
+  tileset_.reset(new DefaultTileset(rng->Next()));
 
-  Level level(size_);
+  Level level(size_, rng);
   vector<Rect> rects;
 
   const int min_size = 6;
@@ -59,10 +68,10 @@ bool RoomAndCorridorMap::TryBuildMap(const Point& size, bool verbose) {
   int tries_left = tries;
 
   while (tries_left > 0) {
-    const Point size{RandInt(min_size, max_size),
-                     RandInt(min_size/2, max_size/2)};
-    const Rect rect{size, {RandInt(1, size_.x - size.x - 1),
-                           RandInt(1, size_.y - size.y - 1)}};
+    const Point size{RandInt(min_size, max_size, rng),
+                     RandInt(min_size/2, max_size/2, rng)};
+    const Rect rect{size, {RandInt(1, size_.x - size.x - 1, rng),
+                           RandInt(1, size_.y - size.y - 1, rng)}};
     if (!level.PlaceRectangularRoom(rect, separation, &rects)) {
       tries_left -= 1;
     }
@@ -113,7 +122,7 @@ bool RoomAndCorridorMap::TryBuildMap(const Point& size, bool verbose) {
   }
   MAYBE_DEBUG("Added " << IntToString(loop_edges) << " high-ratio loop edges.");
 
-  const double islandness = rand() % 3;
+  const double islandness = rng->Uniform(3);
   for (int i = 0; i < 3; i++) {
     level.Erode(islandness);
   }
@@ -130,7 +139,7 @@ bool RoomAndCorridorMap::TryBuildMap(const Point& size, bool verbose) {
   MAYBE_DEBUG("Dug " << IntToString(edges.size()) << " corridors.");
 
   level.AddWalls();
-  starting_square_ = rooms_[0].GetRandomSquare();
+  starting_square_ = rooms_[0].GetRandomSquare(rng);
   MAYBE_DEBUG("Final map:" << level.ToDebugString());
   PackTiles(level.tiles);
   return true;
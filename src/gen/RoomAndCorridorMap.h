@@ -1,6 +1,7 @@
 #ifndef __BABEL_GEN_ROOM_AND_CORRIDOR_MAP_H__
 #define __BABEL_GEN_ROOM_AND_CORRIDOR_MAP_H__
 
+#include "base/rng.h"
 #include "engine/TileMap.h"
 
 namespace babel {
@@ -8,10 +9,11 @@ namespace gen {
 
 class RoomAndCorridorMap : public engine::TileMap {
  public:
-  RoomAndCorridorMap(const Point& size, bool verbose=false);
+  // Does NOT take ownership of the rng, which is only used during the call.
+  RoomAndCorridorMap(const Point& size, RNG* rng, bool verbose=false);
 
  private:
-  bool TryBuildMap(const Point& size, bool verbose);
+  bool TryBuildMap(const Point& size, RNG* rng, bool verbose);
 };
 
 }  // namespace gen
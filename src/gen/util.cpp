@@ -53,7 +53,7 @@ inline bool IsTileBlocked(Tile tile) {
   return tile == Tile::DEFAULT || tile == Tile::WALL;
 }
 
-void AddDoor(const Point& square, const Room& room,
+void AddDoor(const Point& square, const Room& room, RNG* rng,
              TileArray* tiles, Array2d<bool>* diggable) {
   for (const Point& step : kKingMoves) {
     const Point neighbor = square + step;
@@ -61,7 +61,7 @@ void AddDoor(const Point& square, const Room& room,
       (*diggable)[neighbor.x][neighbor.y] = false;
     }
   }
-  if (rand() % 2 == 0) {
+  if (rng->Uniform(2) == 0) {
     (*tiles)[square.x][square.y] = Tile::DOOR;
   }
 }
@@ -120,10 +120,10 @@ bool HasNeighborInRoom(const Array2d<rid>& rids, const Point& square,
 
 }  // namespace
 
-Level::Level(const Point& s)
+Level::Level(const Point& s, RNG* r)
     : size(s), tiles(ConstructArray2d<Tile>(s, Tile::DEFAULT)),
       rids(ConstructArray2d<rid>(s, 0)),
-      diggable(ConstructArray2d<bool>(s, true)) {}
+      diggable(ConstructArray2d<bool>(s, true)), rng(r) {}
 
 void Level::AddWalls() {
   for (int x = 0; x < size.x; x++) {
@@ -147,8 +147,8 @@ bool Level::DigCorridor(const vector<Room>& rooms, int index1,
                         int index2, double windiness) {
   const Room& r1 = rooms[index1];
   const Room& r2 = rooms[index2];
-  const Point source = r1.GetRandomSquare();
-  const Point target = r2.GetRandomSquare();
+  const Point source = r1.GetRandomSquare(rng);
+  const Point target = r2.GetRandomSquare(rng);
   ASSERT(InBounds(source, size) && diggable[source.x][source.y]);
   ASSERT(InBounds(target, size) && diggable[target.x][target.y]);
 
@@ -237,8 +237,9 @@ bool Level::DigCorridor(const vector<Room>& rooms, int index1,
       tiles[node.x][node.y] = Tile::FREE;
     }
   }
-  AddDoor(truncated_path[1], r2, &tiles, &diggable);
-  AddDoor(truncated_path[truncated_path.size() - 2], r1, &tiles, &diggable);
+  AddDoor(truncated_path[1], r2, rng, &tiles, &diggable);
+  AddDoor(truncated_path[truncated_path.size() - 2], r1, rng,
+          &tiles, &diggable);
   return true;
 }
 
@@ -262,8 +263,8 @@ void Level::Erode(int islandness) {
       const int inverse_free_to_blocked = 4;
       const int cutoff = max(8 - matches, matches - 8 + islandness);
       const bool changed =
-          (blocked ? (rand() % (8*inverse_blocked_to_free)) < 8 - matches :
-                     (rand() % (8*inverse_free_to_blocked)) < cutoff);
+          (blocked ? rng->Uniform(8*inverse_blocked_to_free) < 8 - matches :
+                     rng->Uniform(8*inverse_free_to_blocked) < cutoff);
       if (changed) {
         new_rids[x][y] = (blocked ? room_index : 0);
         tiles[x][y] = (blocked ? Tile::FREE : Tile::DEFAULT);
@@ -276,9 +277,6 @@ void Level::Erode(int islandness) {
 void Level::ExtractFinalRooms(int n, vector<Room>* rooms) {
   rooms->clear();
   rooms->resize(n);
-  for (int i = 0; i < n; i++) {
-    rooms->push_back(Room());
-  }
   for (int x = 0; x < size.x; x++) {
     for (int y = 0; y < size.y; y++) {
       const rid room_index = rids[x][y];
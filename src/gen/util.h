@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "base/point.h"
+#include "base/rng.h"
 #include "engine/Tileset.h"
 #include "engine/TileMap.h"
 
@@ -32,7 +33,8 @@ struct Rect {
 typedef unsigned char rid;
 
 struct Level {
-  Level(const Point& size);
+  // Does NOT take ownership of the rng, which is used for all randomness.
+  Level(const Point& size, RNG* rng);
 
   // Turns any DEFAULT square adjacent to a FREE square into a wall.
   void AddWalls();
@@ -66,11 +68,12 @@ struct Level {
   TileArray tiles;
   Array2d<rid> rids;
   Array2d<bool> diggable;
+  RNG* rng;
 };
 
 // Returns a random integer in [x, y]. NOTE: the range is inclusive!
-inline int RandInt(int x, int y) {
-  return (rand() % (y - x + 1)) + x;
+inline int RandInt(int x, int y, RNG* rng) {
+  return rng->Uniform(y - x + 1) + x;
 }
 
 // Returns the L2 distance between the two rooms.
@@ -0,0 +1,167 @@
+// Load generator for the multi-session server. It starts a session manager
+// and its socket front door in-process, connects a number of clients over the
+// socket, and has each client play its share of the sessions with random
+// moves at a fixed rate. At the end it reports the throughput per worker
+// thread and the distribution of Engine::Update latencies.
+//
+// Usage: loadgen [sessions] [num_workers] [seconds] [moves_per_session_per_s]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "base/debug.h"
+#include "base/histogram.h"
+#include "base/rng.h"
+#include "base/timing.h"
+#include "server/SessionManager.h"
+#include "server/SocketServer.h"
+
+using babel::RNG;
+using babel::tick;
+using std::string;
+using std::vector;
+
+namespace {
+
+static const int kNumClients = 8;
+
+// A blocking, line-at-a-time client for the socket front door.
+class Client {
+ public:
+  Client(const string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT(fd_ >= 0);
+    ASSERT(connect(fd_, (sockaddr*)&address, sizeof(address)) == 0);
+  }
+
+  ~Client() { close(fd_); }
+
+  string Request(const string& request) {
+    const string line = request + "\n";
+    ASSERT(write(fd_, line.data(), line.size()) == (ssize_t)line.size());
+    while (true) {
+      const size_t end = buffer_.find('\n');
+      if (end != string::npos) {
+        const string response = buffer_.substr(0, end);
+        buffer_.erase(0, end + 1);
+        return response;
+      }
+      char data[256];
+      const ssize_t size = read(fd_, data, sizeof(data));
+      ASSERT(size > 0);
+      buffer_.append(data, size);
+    }
+  }
+
+ private:
+  int fd_;
+  string buffer_;
+};
+
+void RunClient(const string& path, int first_session, int num_sessions,
+               double rate, int seconds, std::atomic<int>* moves) {
+  Client client(path);
+  vector<string> ids;
+  for (int i = 0; i < num_sessions; i++) {
+    const string response =
+        client.Request("NEW " + std::to_string(first_session + i));
+    ASSERT(response.substr(0, 3) == "OK ");
+    ids.push_back(response.substr(3));
+  }
+  // Games are built on the workers, and a session's status is all zeros
+  // until its game is built. Wait for them, so that building them is not
+  // part of the timed run.
+  for (const string& id : ids) {
+    while (client.Request("STATUS " + id) == "OK 0 0 0") {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  // Each pass sends one move to every session, paced to the target rate.
+  RNG rng(first_session);
+  const tick period = 1000000/rate;
+  const tick end = babel::GetCurrentTick() + seconds*1000000LL;
+  for (tick next = babel::GetCurrentTick(); next < end; next += period) {
+    for (const string& id : ids) {
+      const int dx = rng.Uniform(3) - 1;
+      const int dy = rng.Uniform(3) - 1;
+      const string response = client.Request(
+          "MOVE " + id + " " + std::to_string(dx) + " " + std::to_string(dy));
+      ASSERT(response == "OK");
+      *moves += 1;
+    }
+    const tick now = babel::GetCurrentTick();
+    if (now < next + period) {
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(next + period - now));
+    }
+  }
+  for (const string& id : ids) {
+    client.Request("END " + id);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+  const int num_sessions = argc > 1 ? atoi(argv[1]) : 1000;
+  const int num_workers =
+      argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency();
+  const int seconds = argc > 3 ? atoi(argv[3]) : 10;
+  const double rate = argc > 4 ? atof(argv[4]) : 2.0;
+  const string path = "/tmp/babel-loadgen-" + std::to_string(getpid());
+
+  babel::server::SessionManager manager(std::max(num_workers, 1),
+                                        std::max(num_sessions, 1));
+  babel::server::SocketServer server(&manager, path);
+  if (!server.Start()) {
+    fprintf(stderr, "Failed to listen on %s\n", path.c_str());
+    return 1;
+  }
+
+  std::atomic<int> moves(0);
+  vector<std::thread> clients;
+  for (int i = 0; i < kNumClients; i++) {
+    const int first = num_sessions*i/kNumClients;
+    const int last = num_sessions*(i + 1)/kNumClients;
+    clients.emplace_back(RunClient, path, first, last - first, rate, seconds,
+                         &moves);
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  server.Stop();
+
+  const babel::Histogram latencies = manager.GetUpdateLatencies();
+  const long long n = latencies.count();
+  const tick busy = latencies.sum();
+  // Worker time per update bounds how many sessions one core can keep up
+  // with at the given input rate.
+  const double mean_us = n == 0 ? 0 : (double)busy/n;
+  const double sessions_per_core = mean_us == 0 ? 0 : 1e6/(mean_us*rate);
+
+  printf("sessions:          %d over %d clients\n",
+         num_sessions, kNumClients);
+  printf("workers:           %d\n", manager.GetNumWorkers());
+  printf("moves sent:        %d in %ds (target %.0f/s, got %.0f/s)\n",
+         (int)moves, seconds, num_sessions*rate, (double)moves/seconds);
+  printf("updates processed: %lld\n", n);
+  printf("update latency:    p50 %lldus, p99 %lldus, mean %.1fus\n",
+         latencies.Percentile(0.5), latencies.Percentile(0.99), mean_us);
+  printf("worker utilization: %.1f%%\n",
+         100.0*busy/(seconds*1e6*manager.GetNumWorkers()));
+  printf("sessions per core at %.1f moves/s: %.0f\n", rate, sessions_per_core);
+}
@@ -9,14 +9,15 @@
 #include "engine/Engine.h"
 
 int main(int argc, char** argv) {
-  const int seed = time(nullptr);
-  DEBUG("Using seed " << seed);
-  srand(seed);
   babel::RegisterCrashHandlers(argv[0]);
   #ifdef EMSCRIPTEN
+  // The page constructs the Engine, which picks its own seed (see GetSeed).
   emscripten_exit_with_live_runtime();
   #else
+  const int seed = time(nullptr);
+  DEBUG("Using seed " << seed);
   const babel::Point kMapSize(64, 64);
-  babel::gen::RoomAndCorridorMap map(kMapSize, true /* debug */);
+  babel::RNG rng(seed);
+  babel::gen::RoomAndCorridorMap map(kMapSize, &rng, true /* debug */);
   #endif  // EMSCRIPTEN
 }
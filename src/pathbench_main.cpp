@@ -0,0 +1,262 @@
+// Benchmarks the pathfinders against each other on random queries. For each
+// map, it finds paths between the same pairs of random free squares with each
+// search, and reports the time per query, the fraction of queries that found
+// a path, the average path cost and number of squares (or abstract nodes)
+// expanded, and the number of paths that cost more than A*'s with the same
+// costs. Jump point search is compared with doors and fences impassable, as it
+// requires, and hierarchical search with the default costs, on levels only.
+//
+// With doors impassable, most pairs of squares on a level are unreachable,
+// and a failed search costs very different amounts in each backend. So the
+// time per query is reported separately for queries that found a path and
+// for those that did not, and only the former should be compared.
+//
+// Usage: pathbench [queries] [world_file...]
+//
+// The maps are generated 48x24 and 256x128 RoomAndCorridorMap levels, plus
+// the given 1024x1024 world files (by default, meteor/public/*World.dat). As
+// in fovbench, squares in world files with variant 0 are treated as walls.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/debug.h"
+#include "base/rng.h"
+#include "base/timing.h"
+#include "engine/HierarchicalPathfinder.h"
+#include "engine/Pathfinder.h"
+#include "engine/TileMap.h"
+#include "gen/RoomAndCorridorMap.h"
+
+using babel::Point;
+using babel::RNG;
+using babel::engine::HierarchicalPathfinder;
+using babel::engine::MoveCosts;
+using babel::engine::Pathfinder;
+using babel::engine::Tile;
+using babel::engine::TileMap;
+using std::string;
+using std::vector;
+
+namespace {
+
+static const int kNumLevels = 20;
+static const int kNumLargeLevels = 4;
+static const int kWorldSize = 1024;
+
+static const MoveCosts kNoDoorCosts = {
+    2, 3, MoveCosts::kImpassable, MoveCosts::kImpassable};
+
+enum Search {ASTAR, JUMP_POINT_SEARCH, HIERARCHICAL};
+
+struct Backend {
+  Search search;
+  const MoveCosts* costs;
+  const char* name;
+  // The index of the backend whose path costs this one should match, or -1.
+  int reference;
+  // Hierarchical search needs rooms, so those backends only run on levels.
+  bool levels_only;
+};
+
+const Backend kBackends[] = {
+    {ASTAR, &kNoDoorCosts, "A*", -1, false},
+    {JUMP_POINT_SEARCH, &kNoDoorCosts, "jump point search", 0, false},
+    {ASTAR, &babel::engine::kDefaultMoveCosts, "A*, doors", -1, true},
+    {HIERARCHICAL, &babel::engine::kDefaultMoveCosts, "hierarchical, doors",
+     2, true}};
+
+class WorldTileset : public babel::engine::Tileset {
+ public:
+  babel::engine::Graphic GetGraphicForTile(Tile tile) const override {
+    return tile;
+  }
+};
+
+class WorldMap : public TileMap {
+ public:
+  bool Load(const string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    const string bytes = stream.str();
+    if (!file || bytes.size() != kWorldSize*kWorldSize) {
+      return false;
+    }
+    size_ = Point(kWorldSize, kWorldSize);
+    tileset_.reset(new WorldTileset);
+    vector<vector<Tile>> tiles(kWorldSize, vector<Tile>(kWorldSize));
+    for (int y = 0; y < kWorldSize; y++) {
+      for (int x = 0; x < kWorldSize; x++) {
+        tiles[x][y] = (bytes[y*kWorldSize + x] == 0 ? Tile::WALL : Tile::FREE);
+      }
+    }
+    PackTiles(tiles);
+    return true;
+  }
+};
+
+struct Result {
+  // Time spent on queries that found a path and on those that did not.
+  babel::tick elapsed_found = 0;
+  babel::tick elapsed_missed = 0;
+  int queries = 0;
+  long long found = 0;
+  long long cost = 0;
+  long long expanded = 0;
+  long long worse = 0;
+};
+
+Point GetFreeSquare(const TileMap& map, RNG* rng) {
+  while (true) {
+    const Point square(rng->Uniform(map.GetSize().x),
+                       rng->Uniform(map.GetSize().y));
+    if (!map.IsSquareBlocked(square)) {
+      return square;
+    }
+  }
+}
+
+int GetCost(const TileMap& map, const MoveCosts& costs, const Point& source,
+            const vector<Point>& path) {
+  int cost = 0;
+  Point square = source;
+  for (const Point& next : path) {
+    const Point step = next - square;
+    cost += babel::engine::GetStepCost(
+        map.GetTile(next), step.x != 0 && step.y != 0, costs);
+    square = next;
+  }
+  return cost;
+}
+
+// Adds the results for each backend on the map to results.
+void Benchmark(const TileMap& map, int queries, bool level,
+               vector<Result>* results) {
+  RNG rng(queries);
+  vector<std::pair<Point,Point>> pairs;
+  for (int i = 0; i < queries; i++) {
+    const Point source = GetFreeSquare(map, &rng);
+    pairs.push_back(std::make_pair(source, GetFreeSquare(map, &rng)));
+  }
+  // Build the jump point table and the hierarchical graph up front, so that
+  // the timed queries do not include building them.
+  Pathfinder pathfinder(map);
+  map.GetJumpPointTable();
+  std::unique_ptr<HierarchicalPathfinder> hierarchical;
+  if (level) {
+    hierarchical.reset(new HierarchicalPathfinder(
+        map, babel::engine::kDefaultMoveCosts));
+  }
+  vector<Point> path;
+  vector<vector<int>> costs(results->size());
+  for (int i = 0; i < (int)results->size(); i++) {
+    const Backend& backend = kBackends[i];
+    if (backend.levels_only && !level) {
+      continue;
+    }
+    Result& result = (*results)[i];
+    for (int j = 0; j < (int)pairs.size(); j++) {
+      const Point& source = pairs[j].first;
+      const Point& target = pairs[j].second;
+      const babel::tick start = babel::GetCurrentTick();
+      bool found = false;
+      if (backend.search == ASTAR) {
+        found = pathfinder.FindPath(source, target, *backend.costs, &path);
+      } else if (backend.search == JUMP_POINT_SEARCH) {
+        found = pathfinder.FindJumpPointPath(
+            source, target, *backend.costs, &path);
+      } else {
+        found = hierarchical->FindPath(source, target, &path);
+      }
+      (found ? result.elapsed_found : result.elapsed_missed) +=
+          babel::GetCurrentTick() - start;
+      result.queries += 1;
+      result.expanded += (backend.search == HIERARCHICAL ?
+                          hierarchical->GetNumExpanded() :
+                          pathfinder.GetNumExpanded());
+      const int cost =
+          (found ? GetCost(map, *backend.costs, source, path) : -1);
+      costs[i].push_back(cost);
+      if (backend.reference >= 0 && cost != costs[backend.reference][j]) {
+        result.worse += 1;
+      }
+      if (found) {
+        result.found += 1;
+        result.cost += cost;
+      }
+    }
+  }
+}
+
+void PrintResults(const string& title, const vector<Result>& results) {
+  printf("%s (%d queries)\n", title.c_str(), results[0].queries);
+  for (int i = 0; i < (int)results.size(); i++) {
+    const Result& result = results[i];
+    const double queries = result.queries;
+    const long long missed = result.queries - result.found;
+    if (result.queries == 0) {
+      continue;
+    }
+    printf("  %-20s %9.2fus/found  %9.2fus/missed  %5.1f%% found  "
+           "%7.1f cost  %9.1f expanded  %lld worse\n",
+           kBackends[i].name,
+           result.found > 0 ? 1.0*result.elapsed_found/result.found : 0.0,
+           missed > 0 ? 1.0*result.elapsed_missed/missed : 0.0,
+           100*result.found/queries,
+           result.found > 0 ? 1.0*result.cost/result.found : 0.0,
+           result.expanded/queries, result.worse);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+  const int queries = argc > 1 ? atoi(argv[1]) : 1000;
+  vector<string> worlds;
+  for (int i = 2; i < argc; i++) {
+    worlds.push_back(argv[i]);
+  }
+  if (argc <= 2) {
+    worlds = {"meteor/public/grassWorld.dat", "meteor/public/rockWorld.dat"};
+  }
+  if (queries <= 0) {
+    fprintf(stderr, "Usage: %s [queries] [world_file...]\n", argv[0]);
+    return 1;
+  }
+
+  const int num_backends = sizeof(kBackends)/sizeof(kBackends[0]);
+  vector<Result> results(num_backends);
+  for (int i = 0; i < kNumLevels; i++) {
+    RNG rng(i);
+    babel::gen::RoomAndCorridorMap level(Point(48, 24), &rng);
+    Benchmark(level, queries, true /* level */, &results);
+  }
+  PrintResults("48x24 RoomAndCorridorMap levels", results);
+
+  results = vector<Result>(num_backends);
+  for (int i = 0; i < kNumLargeLevels; i++) {
+    RNG rng(i);
+    babel::gen::RoomAndCorridorMap level(Point(256, 128), &rng);
+    Benchmark(level, queries, true /* level */, &results);
+  }
+  PrintResults("256x128 RoomAndCorridorMap levels", results);
+
+  for (const string& filename : worlds) {
+    WorldMap map;
+    if (!map.Load(filename)) {
+      fprintf(stderr, "Failed to load %s\n", filename.c_str());
+      return 1;
+    }
+    vector<Result> results(num_backends);
+    Benchmark(map, queries, false /* level */, &results);
+    PrintResults(filename, results);
+  }
+  return 0;
+}
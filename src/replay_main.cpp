@@ -0,0 +1,108 @@
+// Records and replays input journals, for profiling and regression hunting.
+//
+// Usage: replay record <seed> <num_inputs> <journal_file>
+//        replay play <journal_file>
+//
+// record plays a game with random moves and writes its journal. play replays
+// a journal and reports its speed.
+// Both print a digest of the final view, which matches iff the games match.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "base/debug.h"
+#include "base/rng.h"
+#include "base/timing.h"
+#include "engine/Engine.h"
+#include "engine/Journal.h"
+#include "engine/View.h"
+
+using babel::Point;
+using babel::engine::Action;
+using babel::engine::Engine;
+using babel::engine::Journal;
+using std::string;
+using std::unique_ptr;
+
+namespace {
+
+uint64_t GetDigest(const Engine& engine) {
+  unique_ptr<babel::engine::View> view(engine.GetView(Point(48, 24)));
+  uint64_t digest = engine.GetNumTurns();
+  for (const auto& column : view->tiles) {
+    for (const auto& tile : column) {
+      digest = 31*digest + 2*tile.graphic + tile.visible;
+    }
+  }
+  for (const auto& sprite : view->sprites) {
+    digest = 31*digest + sprite.id;
+    digest = 31*digest + sprite.graphic;
+    digest = 31*digest + 256*sprite.square.x + sprite.square.y;
+  }
+  digest = 31*digest + view->status.cur_health;
+  return digest;
+}
+
+int Record(uint32_t seed, int num_inputs, const string& filename) {
+  Engine engine(seed);
+  engine.StartJournal();
+  babel::RNG rng(seed);
+  for (int i = 0; i < num_inputs; i++) {
+    engine.AddInput(Action::Move(Point(rng.Uniform(3) - 1,
+                                       rng.Uniform(3) - 1)));
+    engine.Update();
+  }
+  std::ofstream file(filename, std::ios::binary);
+  file << engine.GetJournal()->GetBytes();
+  if (!file) {
+    fprintf(stderr, "Failed to write %s\n", filename.c_str());
+    return 1;
+  }
+  printf("recorded %d inputs, %lld turns, %zu bytes\n", num_inputs,
+         engine.GetNumTurns(), engine.GetJournal()->GetBytes().size());
+  printf("digest %llu\n", (unsigned long long)GetDigest(engine));
+  return 0;
+}
+
+int Play(const string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  std::stringstream bytes;
+  bytes << file.rdbuf();
+  Journal journal(0);
+  if (!file || !journal.Load(bytes.str())) {
+    fprintf(stderr, "Failed to load %s\n", filename.c_str());
+    return 1;
+  }
+  const babel::tick start = babel::GetCurrentTick();
+  unique_ptr<Engine> engine(Engine::Replay(journal));
+  const babel::tick elapsed = babel::GetCurrentTick() - start;
+  if (engine == nullptr) {
+    fprintf(stderr, "Failed to replay %s\n", filename.c_str());
+    return 1;
+  }
+  printf("replayed %lld turns in %lldus (%.0f turns/s)\n",
+         engine->GetNumTurns(), elapsed,
+         1e6*engine->GetNumTurns()/std::max(elapsed, 1LL));
+  printf("digest %llu\n", (unsigned long long)GetDigest(*engine));
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+  const string mode = argc > 1 ? argv[1] : "";
+  if (mode == "record" && argc == 5) {
+    return Record(atoi(argv[2]), atoi(argv[3]), argv[4]);
+  } else if (mode == "play" && argc == 3) {
+    return Play(argv[2]);
+  }
+  fprintf(stderr, "Usage: %s record <seed> <num_inputs> <journal_file>\n"
+                  "       %s play <journal_file>\n", argv[0], argv[0]);
+  return 1;
+}
@@ -0,0 +1,154 @@
+// Benchmarks the Scheduler against the round-robin energy polling that it
+// replaced. For each population, it adds the same sprites to a SpriteStore,
+// runs a fixed number of turns per sprite with both schedulers, and reports
+// the time per turn, the number of sprites visited per turn, and the number
+// of turns that went to a different sprite than under polling.
+//
+// Usage: schedbench [turns_per_sprite]
+//
+// Populations mix the game's geckos and drones, whose speeds mean that
+// polling visits about eight sprites per turn, and slow creatures, whose
+// speeds are overwritten in the store so that polling visits hundreds.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "base/creature.h"
+#include "base/debug.h"
+#include "base/rng.h"
+#include "base/timing.h"
+#include "engine/Scheduler.h"
+#include "engine/Sprite.h"
+#include "engine/SpriteStore.h"
+
+using babel::Point;
+using babel::RNG;
+using babel::engine::Scheduler;
+using babel::engine::Sprite;
+using babel::engine::SpriteStore;
+using babel::engine::kEnergyNeededToMove;
+using std::string;
+using std::vector;
+
+namespace {
+
+static const int kPopulations[] = {10, 100, 1000, 10000};
+
+struct Mix {
+  const char* name;
+  // If positive, every sprite's speed is drawn uniformly from [1, max_speed]
+  // instead of coming from its creature.
+  int max_speed;
+};
+
+const Mix kMixes[] = {{"geckos and drones", 0}, {"slow creatures", 4}};
+
+struct Result {
+  babel::tick elapsed = 0;
+  long long turns = 0;
+  long long visits = 0;
+  long long mismatches = 0;
+};
+
+void AddSprites(int n, const Mix& mix, SpriteStore* store) {
+  RNG rng(n);
+  for (int i = 0; i < n; i++) {
+    const int type = (rng.Uniform(2) == 0 ? babel::mGecko : babel::mDrone);
+    store->Add(Point(i, 0), type, rng.Uniform(kEnergyNeededToMove));
+    if (mix.max_speed > 0) {
+      store->speeds[i] = rng.Uniform(mix.max_speed) + 1;
+    }
+  }
+}
+
+// Visits the sprites round-robin, gaining energy on each visit, as the engine
+// did before Scheduler, through the same Sprite proxy calls. Appends the index
+// of the sprite that takes each turn.
+void Poll(SpriteStore* store, int turns, vector<int>* order, Result* result) {
+  const int n = store->size();
+  vector<int>& energies = store->energies;
+  const vector<int>& speeds = store->speeds;
+  const babel::tick start = babel::GetCurrentTick();
+  int index = 0;
+  for (int turn = 0; turn < turns;) {
+    result->visits += 1;
+    Sprite* sprite = store->At(index);
+    if (!sprite->HasEnergyNeededToMove()) {
+      energies[index] += speeds[index];
+    }
+    if (sprite->HasEnergyNeededToMove()) {
+      sprite->ConsumeEnergy();
+      order->push_back(index);
+      turn += 1;
+    }
+    index = (index + 1 == n ? 0 : index + 1);
+  }
+  result->elapsed += babel::GetCurrentTick() - start;
+  result->turns += turns;
+}
+
+// Runs the same turns through a Scheduler. Each turn visits one sprite.
+void Schedule(SpriteStore* store, int turns, vector<int>* order,
+              Result* result) {
+  Scheduler scheduler;
+  for (int i = 0; i < store->size(); i++) {
+    scheduler.AddSprite(store->At(i));
+  }
+  const babel::tick start = babel::GetCurrentTick();
+  for (int turn = 0; turn < turns; turn++) {
+    Sprite* sprite = scheduler.GetCurrentSprite();
+    sprite->ConsumeEnergy();
+    order->push_back(sprite->square().x);
+    scheduler.AdvanceSprite();
+  }
+  result->elapsed += babel::GetCurrentTick() - start;
+  result->turns += turns;
+  result->visits += turns;
+}
+
+void PrintResult(const string& name, const Result& result) {
+  const double turns = result.turns;
+  printf("  %-10s %9.3fus/turn  %7.1f visits/turn  %lld mismatches\n",
+         name.c_str(), result.elapsed/turns, result.visits/turns,
+         result.mismatches);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+  const int turns_per_sprite = argc > 1 ? atoi(argv[1]) : 20;
+  if (turns_per_sprite <= 0) {
+    fprintf(stderr, "Usage: %s [turns_per_sprite]\n", argv[0]);
+    return 1;
+  }
+
+  for (const Mix& mix : kMixes) {
+    for (const int n : kPopulations) {
+      const int turns = n*turns_per_sprite;
+      vector<int> polled;
+      vector<int> scheduled;
+      Result polling;
+      Result scheduler;
+      {
+        SpriteStore store;
+        AddSprites(n, mix, &store);
+        Poll(&store, turns, &polled, &polling);
+      }
+      {
+        SpriteStore store;
+        AddSprites(n, mix, &store);
+        Schedule(&store, turns, &scheduled, &scheduler);
+      }
+      for (int i = 0; i < turns; i++) {
+        scheduler.mismatches += (polled[i] != scheduled[i]);
+      }
+      printf("%s, n=%d (%d turns)\n", mix.name, n, turns);
+      PrintResult("polling", polling);
+      PrintResult("scheduler", scheduler);
+    }
+  }
+  return 0;
+}
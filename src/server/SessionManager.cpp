@@ -0,0 +1,218 @@
+#ifndef EMSCRIPTEN
+
+#include "server/SessionManager.h"
+
+#include <utility>
+
+#include "base/debug.h"
+#include "base/timing.h"
+
+using std::lock_guard;
+using std::mutex;
+using std::shared_ptr;
+using std::unique_lock;
+using std::vector;
+
+namespace babel {
+namespace server {
+
+struct SessionManager::Session {
+  Session(uint32_t seed) : seed(seed) {}
+
+  // Only the worker that has the session scheduled may touch the engine,
+  // which is null until that worker builds it.
+  const uint32_t seed;
+  std::unique_ptr<engine::Engine> engine;
+
+  // mutex guards the rest of the session's fields.
+  std::mutex mutex;
+  vector<engine::Action> inputs;
+  SessionStatus status{0, engine::StatusView{0, 0}};
+  // True while the session is in the ready queue or being stepped. A new
+  // session starts scheduled, so that its first step builds the game.
+  bool scheduled = true;
+  bool destroyed = false;
+};
+
+struct SessionManager::Worker {
+  std::thread thread;
+  std::mutex mutex;
+  Histogram latencies;
+};
+
+SessionManager::SessionManager(int num_workers, int max_sessions)
+    : max_sessions_(max_sessions) {
+  ASSERT(num_workers > 0);
+  ASSERT(max_sessions > 0);
+  for (int i = 0; i < num_workers; i++) {
+    workers_.emplace_back(new Worker);
+  }
+  for (auto& worker : workers_) {
+    worker->thread = std::thread(&SessionManager::RunWorker, this,
+                                 worker.get());
+  }
+}
+
+SessionManager::~SessionManager() {
+  {
+    lock_guard<mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  ready_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+SessionId SessionManager::CreateSession(uint32_t seed) {
+  shared_ptr<Session> session(new Session(seed));
+  SessionId id;
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (sessions_.size() >= max_sessions_) {
+      return kInvalidSession;
+    }
+    id = sessions_.Add(session);
+  }
+  Schedule(std::move(session));
+  return id;
+}
+
+bool SessionManager::DestroySession(SessionId id) {
+  shared_ptr<Session> session;
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (!sessions_.Contains(id)) {
+      return false;
+    }
+    session = *sessions_.Get(id);
+    sessions_.Remove(id);
+  }
+  lock_guard<mutex> lock(session->mutex);
+  session->destroyed = true;
+  session->inputs.clear();
+  return true;
+}
+
+bool SessionManager::AddInput(SessionId id, const engine::Action& input) {
+  shared_ptr<Session> session = GetSession(id);
+  if (session == nullptr) {
+    return false;
+  }
+  bool schedule = false;
+  {
+    lock_guard<mutex> lock(session->mutex);
+    session->inputs.push_back(input);
+    schedule = !session->scheduled;
+    session->scheduled = true;
+  }
+  if (schedule) {
+    Schedule(std::move(session));
+  }
+  return true;
+}
+
+bool SessionManager::GetStatus(SessionId id, SessionStatus* status) const {
+  ASSERT(status != nullptr);
+  shared_ptr<Session> session = GetSession(id);
+  if (session == nullptr) {
+    return false;
+  }
+  lock_guard<mutex> lock(session->mutex);
+  *status = session->status;
+  return true;
+}
+
+int SessionManager::GetNumSessions() const {
+  lock_guard<mutex> lock(mutex_);
+  return sessions_.size();
+}
+
+Histogram SessionManager::GetUpdateLatencies() const {
+  Histogram result;
+  for (const auto& worker : workers_) {
+    lock_guard<mutex> lock(worker->mutex);
+    result.Merge(worker->latencies);
+  }
+  return result;
+}
+
+void SessionManager::RunWorker(Worker* worker) {
+  while (true) {
+    shared_ptr<Session> session;
+    {
+      unique_lock<mutex> lock(mutex_);
+      ready_cv_.wait(lock, [this]{ return stopping_ || !ready_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      session = std::move(ready_.front());
+      ready_.pop_front();
+    }
+    Step(session.get(), worker);
+
+    // If more input arrived while the session was being stepped, it goes to
+    // the back of the queue, so that busy sessions cannot starve the rest.
+    bool requeue = false;
+    {
+      lock_guard<mutex> lock(session->mutex);
+      requeue = !session->inputs.empty();
+      session->scheduled = requeue;
+    }
+    if (requeue) {
+      Schedule(std::move(session));
+    }
+  }
+}
+
+void SessionManager::Step(Session* session, Worker* worker) {
+  vector<engine::Action> inputs;
+  {
+    lock_guard<mutex> lock(session->mutex);
+    if (session->destroyed) {
+      return;
+    }
+    inputs.swap(session->inputs);
+  }
+  // Map generation is slow, so it happens here rather than on the caller's
+  // thread in CreateSession.
+  if (session->engine == nullptr) {
+    session->engine.reset(new engine::Engine(session->seed));
+  }
+  vector<tick> latencies;
+  for (const engine::Action& input : inputs) {
+    session->engine->AddInput(input);
+    const tick start = GetCurrentTick();
+    session->engine->Update();
+    latencies.push_back(GetCurrentTick() - start);
+  }
+  {
+    lock_guard<mutex> lock(session->mutex);
+    session->status.updates += inputs.size();
+    session->status.status = session->engine->GetStatus();
+  }
+  lock_guard<mutex> lock(worker->mutex);
+  for (tick latency : latencies) {
+    worker->latencies.Add(latency);
+  }
+}
+
+void SessionManager::Schedule(shared_ptr<Session> session) {
+  {
+    lock_guard<mutex> lock(mutex_);
+    ready_.push_back(std::move(session));
+  }
+  ready_cv_.notify_one();
+}
+
+shared_ptr<SessionManager::Session> SessionManager::GetSession(
+    SessionId id) const {
+  lock_guard<mutex> lock(mutex_);
+  const shared_ptr<Session>* session = sessions_.Get(id);
+  return session == nullptr ? nullptr : *session;
+}
+
+}  // namespace server
+}  // namespace babel
+
+#endif  // EMSCRIPTEN
@@ -0,0 +1,94 @@
+// SessionManager hosts many independent games in one process. Each session
+// owns an Engine, and a fixed pool of worker threads steps the sessions that
+// have pending input. A session is stepped by at most one worker at a time,
+// and sessions share no state, so any number of them can run concurrently.
+//
+// Sessions are stepped in the order in which they receive input. Each step
+// feeds a session all of its pending inputs, one Engine::Update per input.
+// A new session's game is built by its first step, on a worker, so creating
+// a session is cheap for the caller; inputs that arrive before the game is
+// built wait for it.
+//
+// All public methods are thread-safe.
+
+#ifndef __BABEL_SERVER_SESSION_MANAGER_H__
+#define __BABEL_SERVER_SESSION_MANAGER_H__
+#ifndef EMSCRIPTEN
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/histogram.h"
+#include "base/slot_map.h"
+#include "engine/Action.h"
+#include "engine/Engine.h"
+
+namespace babel {
+namespace server {
+
+// Session ids are generational handles, like sprite ids. 0 is never an id.
+typedef uint32_t SessionId;
+static const SessionId kInvalidSession = 0;
+
+struct SessionStatus {
+  // The number of inputs that the session has processed.
+  int updates;
+  // All zeros until the session's game has been built.
+  engine::StatusView status;
+};
+
+class SessionManager {
+ public:
+  // Starts num_workers worker threads. The destructor stops them. At most
+  // max_sessions sessions may exist at once.
+  SessionManager(int num_workers, int max_sessions);
+  ~SessionManager();
+
+  // Returns kInvalidSession if there are already max_sessions sessions.
+  SessionId CreateSession(uint32_t seed);
+
+  // These methods return false if the session id is stale. Inputs that were
+  // added to a session before it was destroyed may or may not be processed.
+  bool DestroySession(SessionId id);
+  bool AddInput(SessionId id, const engine::Action& input);
+  bool GetStatus(SessionId id, SessionStatus* status) const;
+
+  int GetNumSessions() const;
+  int GetNumWorkers() const { return workers_.size(); }
+
+  // Returns a histogram of the durations of every Engine::Update so far, in
+  // microseconds.
+  Histogram GetUpdateLatencies() const;
+
+ private:
+  struct Session;
+  struct Worker;
+
+  void RunWorker(Worker* worker);
+  void Step(Session* session, Worker* worker);
+  std::shared_ptr<Session> GetSession(SessionId id) const;
+  // Adds the session to the ready queue. Its scheduled bit must already be
+  // set, and mutex_ must not be held.
+  void Schedule(std::shared_ptr<Session> session);
+
+  // mutex_ guards sessions_, ready_, and stopping_. Lock order: mutex_ is
+  // never acquired while a session's mutex is held.
+  mutable std::mutex mutex_;
+  std::condition_variable ready_cv_;
+  SlotMap<std::shared_ptr<Session>> sessions_;
+  std::deque<std::shared_ptr<Session>> ready_;
+  bool stopping_ = false;
+
+  const int max_sessions_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace server
+}  // namespace babel
+
+#endif  // EMSCRIPTEN
+#endif  // __BABEL_SERVER_SESSION_MANAGER_H__
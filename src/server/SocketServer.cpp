@@ -0,0 +1,236 @@
+#ifndef EMSCRIPTEN
+
+#include "server/SocketServer.h"
+
+#include <cerrno>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "base/debug.h"
+#include "engine/Action.h"
+
+using std::map;
+using std::string;
+using std::stringstream;
+using std::vector;
+
+namespace babel {
+namespace server {
+
+namespace {
+
+static const int kPollTimeoutMs = 100;
+static const int kReadBufferSize = 4096;
+static const size_t kMaxRequestSize = 1024;
+static const size_t kMaxResponseSize = 64*1024;
+static const size_t kMaxSessionsPerConnection = 1024;
+
+bool WouldBlock() {
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+// Sends as much of the data as the socket will take without blocking, and
+// erases what was sent. Returns false if the connection is broken. Sending
+// with MSG_NOSIGNAL reports a closed peer as EPIPE instead of raising
+// SIGPIPE, which would kill the process.
+bool WriteSome(int fd, string* data) {
+  size_t written = 0;
+  while (written < data->size()) {
+    const ssize_t result = send(fd, data->data() + written,
+                                data->size() - written, MSG_NOSIGNAL);
+    if (result < 0 && WouldBlock()) {
+      break;
+    } else if (result <= 0) {
+      return false;
+    }
+    written += result;
+  }
+  data->erase(0, written);
+  return true;
+}
+
+}  // namespace
+
+SocketServer::SocketServer(SessionManager* manager, const string& path)
+    : manager_(manager), path_(path) {
+  ASSERT(manager != nullptr);
+}
+
+SocketServer::~SocketServer() {
+  Stop();
+}
+
+bool SocketServer::Start() {
+  ASSERT(listen_fd_ < 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path_.size() >= sizeof(address.sun_path)) {
+    DEBUG("Socket path is too long: " << path_);
+    return false;
+  }
+  path_.copy(address.sun_path, path_.size());
+  unlink(path_.c_str());
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd_ < 0 ||
+      bind(listen_fd_, (sockaddr*)&address, sizeof(address)) < 0 ||
+      listen(listen_fd_, SOMAXCONN) < 0) {
+    DEBUG("Failed to listen on " << path_);
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+      listen_fd_ = -1;
+    }
+    return false;
+  }
+  thread_ = std::thread(&SocketServer::Run, this);
+  return true;
+}
+
+void SocketServer::Stop() {
+  stopping_.store(true);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(path_.c_str());
+  }
+}
+
+void SocketServer::Run() {
+  // fds[0] is the listening socket. The rest are connections.
+  vector<pollfd> fds{pollfd{listen_fd_, POLLIN, 0}};
+  map<int,Connection> connections;
+
+  while (!stopping_.load()) {
+    for (size_t i = 1; i < fds.size(); i++) {
+      const Connection& connection = connections[fds[i].fd];
+      fds[i].events =
+          (connection.responses.size() < kMaxResponseSize ? POLLIN : 0) |
+          (connection.responses.empty() ? 0 : POLLOUT);
+    }
+    if (poll(fds.data(), fds.size(), kPollTimeoutMs) <= 0) {
+      continue;
+    }
+    if (fds[0].revents & POLLIN) {
+      const int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fds.push_back(pollfd{fd, 0, 0});
+        connections[fd] = Connection();
+      }
+    }
+    for (int i = fds.size() - 1; i > 0; i--) {
+      const pollfd& entry = fds[i];
+      if (entry.revents == 0) {
+        continue;
+      }
+      const int fd = entry.fd;
+      Connection& connection = connections[fd];
+      bool open = !(entry.revents & (POLLERR | POLLNVAL));
+      if (open && (entry.events & POLLIN) &&
+          (entry.revents & (POLLIN | POLLHUP))) {
+        open = ReadRequests(fd, &connection);
+      }
+      if (open && !connection.responses.empty()) {
+        open = WriteSome(fd, &connection.responses);
+      }
+      if (!open) {
+        CloseConnection(fd, &connection);
+        connections.erase(fd);
+        fds.erase(fds.begin() + i);
+      }
+    }
+  }
+  for (auto& pair : connections) {
+    CloseConnection(pair.first, &pair.second);
+  }
+}
+
+bool SocketServer::ReadRequests(int fd, Connection* connection) {
+  char data[kReadBufferSize];
+  const ssize_t size = read(fd, data, sizeof(data));
+  if (size <= 0) {
+    return size < 0 && WouldBlock();
+  }
+  string& requests = connection->requests;
+  requests.append(data, size);
+  size_t start = 0;
+  for (size_t end = requests.find('\n'); end != string::npos;
+       end = requests.find('\n', start)) {
+    connection->responses +=
+        HandleRequest(requests.substr(start, end - start), connection) + "\n";
+    start = end + 1;
+  }
+  requests.erase(0, start);
+  return requests.size() <= kMaxRequestSize;
+}
+
+void SocketServer::CloseConnection(int fd, Connection* connection) {
+  for (const SessionId id : connection->sessions) {
+    manager_->DestroySession(id);
+  }
+  connection->sessions.clear();
+  close(fd);
+}
+
+string SocketServer::HandleRequest(const string& request,
+                                   Connection* connection) {
+  stringstream input(request);
+  stringstream output;
+  string command;
+  SessionId id = kInvalidSession;
+  input >> command;
+
+  if (command == "NEW") {
+    uint32_t seed;
+    if (input >> seed &&
+        connection->sessions.size() < kMaxSessionsPerConnection) {
+      id = manager_->CreateSession(seed);
+    }
+    if (id != kInvalidSession) {
+      connection->sessions.insert(id);
+      output << "OK " << id;
+      return output.str();
+    }
+    return "ERROR";
+  }
+
+  // Every other command names a session, which must be the connection's.
+  if (!(input >> id) || connection->sessions.count(id) == 0) {
+    return "ERROR";
+  }
+  if (command == "MOVE") {
+    Point move;
+    if (input >> move.x >> move.y && abs(move.x) <= 1 && abs(move.y) <= 1 &&
+        manager_->AddInput(id, engine::Action::Move(move))) {
+      return "OK";
+    }
+  } else if (command == "STATUS") {
+    SessionStatus status;
+    if (manager_->GetStatus(id, &status)) {
+      output << "OK " << status.updates << " " << status.status.cur_health
+             << " " << status.status.max_health;
+      return output.str();
+    }
+  } else if (command == "END") {
+    connection->sessions.erase(id);
+    if (manager_->DestroySession(id)) {
+      return "OK";
+    }
+  }
+  return "ERROR";
+}
+
+}  // namespace server
+}  // namespace babel
+
+#endif  // EMSCRIPTEN
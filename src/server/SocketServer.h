@@ -0,0 +1,82 @@
+// SocketServer is a local front door for a SessionManager. It listens on a
+// Unix domain socket and speaks a line-based text protocol, one response line
+// per request line:
+//
+//   NEW <seed>                 -> OK <session>
+//   MOVE <session> <dx> <dy>   -> OK            (the input is queued)
+//   STATUS <session>           -> OK <updates> <cur_health> <max_health>
+//   END <session>              -> OK
+//
+// Requests that are malformed or that name a stale session get "ERROR".
+// All connections are served by a single thread with poll and non-blocking
+// sockets; the games themselves run on the session manager's workers.
+//
+// Each session belongs to the connection that created it. Requests that name
+// another connection's session get "ERROR", and a connection's sessions are
+// destroyed when it closes. NEW gets "ERROR" once the connection has
+// kMaxSessionsPerConnection sessions, or once the session manager is full.
+//
+// A connection's buffers are bounded. A request line longer than
+// kMaxRequestSize drops the connection. Once kMaxResponseSize bytes of
+// responses are waiting for a client, the server stops reading its requests
+// until it reads them, and a client that goes away is dropped.
+
+#ifndef __BABEL_SERVER_SOCKET_SERVER_H__
+#define __BABEL_SERVER_SOCKET_SERVER_H__
+#ifndef EMSCRIPTEN
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include "server/SessionManager.h"
+
+namespace babel {
+namespace server {
+
+class SocketServer {
+ public:
+  // Does NOT take ownership of the session manager.
+  SocketServer(SessionManager* manager, const std::string& path);
+  ~SocketServer();
+
+  // Binds the socket, replacing any file at its path, and starts serving on
+  // a new thread. Returns false if the socket could not be bound.
+  bool Start();
+  void Stop();
+
+ private:
+  void Run();
+
+  // The request and response bytes that are buffered for a connection, and
+  // the sessions that it owns.
+  struct Connection {
+    std::string requests;
+    std::string responses;
+    std::unordered_set<SessionId> sessions;
+  };
+
+  // Returns the response to a single request line, without the newline.
+  std::string HandleRequest(const std::string& request,
+                            Connection* connection);
+
+  // Reads from the connection and handles every complete request line.
+  // Returns false if the connection should be dropped.
+  bool ReadRequests(int fd, Connection* connection);
+
+  // Destroys the connection's sessions and closes its socket.
+  void CloseConnection(int fd, Connection* connection);
+
+  SessionManager* manager_;
+  const std::string path_;
+  int listen_fd_ = -1;
+  std::atomic<bool> stopping_{false};
+  std::thread thread_;
+};
+
+}  // namespace server
+}  // namespace babel
+
+#endif  // EMSCRIPTEN
+#endif  // __BABEL_SERVER_SOCKET_SERVER_H__
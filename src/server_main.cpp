@@ -0,0 +1,51 @@
+// Hosts many games in one process behind a Unix domain socket. See
+// server/SocketServer.h for the protocol.
+//
+// Usage: babel_server [socket_path] [num_workers] [max_sessions]
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "base/debug.h"
+#include "server/SessionManager.h"
+#include "server/SocketServer.h"
+
+namespace {
+
+static const int kDefaultMaxSessions = 4096;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+
+  // Block the stop signals before starting any threads, which inherit the
+  // mask, so that they stay pending until sigwait takes them below.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  const std::string path = argc > 1 ? argv[1] : "/tmp/babel.sock";
+  const int num_workers =
+      argc > 2 ? atoi(argv[2]) : std::thread::hardware_concurrency();
+  const int max_sessions = argc > 3 ? atoi(argv[3]) : kDefaultMaxSessions;
+
+  babel::server::SessionManager manager(std::max(num_workers, 1),
+                                        std::max(max_sessions, 1));
+  babel::server::SocketServer server(&manager, path);
+  if (!server.Start()) {
+    std::cerr << "Failed to listen on " << path << std::endl;
+    return 1;
+  }
+  std::cout << "Serving on " << path << " with " << manager.GetNumWorkers()
+            << " workers." << std::endl;
+
+  int signal;
+  sigwait(&signals, &signal);
+  server.Stop();
+}
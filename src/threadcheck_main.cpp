@@ -0,0 +1,118 @@
+// Stress tests ThreadedEngine. A producer thread adds random moves as fast as
+// the input ring accepts them, retrying whenever it is full, while the main
+// thread runs a render loop that picks up every view that the worker
+// publishes and checks that each one is whole. Then the same moves are played
+// on a synchronous Engine, one input and one Update at a time, and the two
+// engines' journals must be identical: every input that the ring accepted was
+// consumed exactly once, in order, and the game played the same. (Once the
+// player dies, neither engine consumes any more inputs.)
+//
+// Usage: threadcheck [inputs] [seed]
+//
+// Exits with a non-zero status if a view or the journals do not match.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "base/debug.h"
+#include "base/rng.h"
+#include "engine/Action.h"
+#include "engine/Engine.h"
+#include "engine/Journal.h"
+#include "engine/ThreadedEngine.h"
+#include "engine/View.h"
+
+using babel::Point;
+using babel::RNG;
+using babel::engine::Action;
+using babel::engine::Engine;
+using babel::engine::Journal;
+using babel::engine::ThreadedEngine;
+using babel::engine::View;
+using std::vector;
+
+namespace {
+
+static const Point kViewSize(48, 24);
+
+// Returns false if the view does not have the size that it was built with.
+bool IsWhole(const View& view) {
+  if (view.size != kViewSize || (int)view.tiles.size() != view.size.x) {
+    return false;
+  }
+  for (const auto& column : view.tiles) {
+    if ((int)column.size() != view.size.y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  babel::RegisterCrashHandlers(argv[0]);
+  const int num_inputs = argc > 1 ? atoi(argv[1]) : 20000;
+  const uint32_t seed = argc > 2 ? atoi(argv[2]) : 1;
+  if (num_inputs <= 0) {
+    fprintf(stderr, "Usage: %s [inputs] [seed]\n", argv[0]);
+    return 1;
+  }
+
+  ThreadedEngine threaded(seed, kViewSize);
+  threaded.StartJournal();
+  threaded.Start();
+
+  vector<Action> inputs;
+  long long retries = 0;
+  std::atomic<bool> done{false};
+  std::thread producer([&]() {
+    RNG rng(seed);
+    for (int i = 0; i < num_inputs; i++) {
+      const Action input = Action::Move(
+          Point(rng.Uniform(3) - 1, rng.Uniform(3) - 1));
+      while (!threaded.AddInput(input)) {
+        retries += 1;
+        std::this_thread::yield();
+      }
+      inputs.push_back(input);
+    }
+    done.store(true);
+  });
+
+  long long frames = 0;
+  long long broken = 0;
+  while (!done.load()) {
+    frames += 1;
+    broken += !IsWhole(*threaded.GetView());
+  }
+  producer.join();
+  threaded.Stop();
+  broken += !IsWhole(*threaded.GetView());
+
+  Engine expected(seed);
+  expected.StartJournal();
+  for (const Action& input : inputs) {
+    expected.AddInput(input);
+    expected.Update();
+  }
+  const Journal& journal = *threaded.GetJournal();
+  const bool same = (journal.GetBytes() == expected.GetJournal()->GetBytes());
+  int consumed = 0;
+  size_t offset = journal.GetStartOffset();
+  long long turn;
+  Action input;
+  while (journal.Read(&offset, &turn, &input)) {
+    consumed += 1;
+  }
+
+  printf("%d inputs (%lld retries on a full ring), %d consumed, %lld turns\n",
+         num_inputs, retries, consumed, expected.GetNumTurns());
+  printf("%lld frames, %lld broken views\n", frames, broken);
+  printf("journals %s\n", same ? "match" : "DIFFER");
+  return (same && broken == 0) ? 0 : 1;
+}